@@ -0,0 +1,58 @@
+#include "AliasTable.h"
+
+#include <algorithm>
+
+//! Columns are split into those below the mean (small) and those at or above it (large). Each small column is topped up
+//! by a large one, which becomes its alias and loses the weight it gave, and which then joins the small columns if it
+//! fell below the mean. Columns left over at the end are full up to rounding.
+//!
+//! @param  weights The weights.
+AliasTable::AliasTable(std::vector<double> const & weights)
+{
+    double total = 0.0;
+    for (double weight : weights)
+    {
+        total += std::max(weight, 0.0);
+    }
+    if (!(total > 0.0))
+    {
+        return;
+    }
+
+    size_t const n = weights.size();
+    probability.resize(n);
+    alias.resize(n);
+
+    std::vector<uint32_t> small;
+    std::vector<uint32_t> large;
+    for (size_t i = 0; i < n; ++i)
+    {
+        probability[i] = std::max(weights[i], 0.0) * static_cast<double>(n) / total;
+        alias[i]       = static_cast<uint32_t>(i);
+        (probability[i] < 1.0 ? small : large).push_back(static_cast<uint32_t>(i));
+    }
+
+    while (!small.empty() && !large.empty())
+    {
+        uint32_t const s = small.back();
+        uint32_t const l = large.back();
+        small.pop_back();
+        alias[s] = l;
+        probability[l] -= 1.0 - probability[s];
+        if (probability[l] < 1.0)
+        {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+
+    // Whatever remains is full, up to rounding
+    for (uint32_t i : large)
+    {
+        probability[i] = 1.0;
+    }
+    for (uint32_t i : small)
+    {
+        probability[i] = 1.0;
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//! Samples indices from a discrete distribution in constant time with Walker's alias method.
+//!
+//! The n weights are scaled so their mean is 1, and each index i is given a column of height 1 holding the part of its own
+//! weight that fits (probability[i]) and, above it, part of the weight of one other index (alias[i]). A sample picks a
+//! column uniformly and then its own index or its alias, so it costs one random number and two array reads whatever the
+//! number of indices. The tables are built with Vose's method in O(n).
+class AliasTable
+{
+public:
+    //! Constructs an empty table.
+    AliasTable() = default;
+
+    //! Constructs a table sampling each index with probability proportional to its weight.
+    //!
+    //! @param weights  The weights. Negative weights are treated as 0. An index with weight 0 is never sampled.
+    explicit AliasTable(std::vector<double> const & weights);
+
+    //! Returns the number of indices.
+    size_t size() const { return probability.size(); }
+
+    //! Returns true if the table cannot be sampled, because it has no index with a positive weight.
+    bool empty() const { return probability.empty(); }
+
+    //! Returns an index sampled using a uniformly distributed 64-bit random number. The table must not be empty.
+    size_t sample(uint64_t random) const
+    {
+        // The top 53 bits give a point in [0, n), whose integer part picks the column and whose fraction picks the index.
+        // Rounding can give exactly n, which is clamped to the last column.
+        size_t const n      = probability.size();
+        double const x      = static_cast<double>(random >> 11) * 0x1.0p-53 * static_cast<double>(n);
+        size_t const column = std::min(static_cast<size_t>(x), n - 1);
+        return (x - static_cast<double>(column) < probability[column]) ? column : alias[column];
+    }
+
+private:
+    std::vector<double>   probability; // Probability of sampling each column's own index
+    std::vector<uint32_t> alias;       // Index sampled otherwise
+};
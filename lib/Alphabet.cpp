@@ -0,0 +1,275 @@
+#include "Alphabet.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+Alphabet::Alphabet()
+    : Alphabet(VOWELS, CONSONANTS)
+{
+}
+
+//! @param  vowels      The vowels.
+//! @param  consonants  The consonants.
+//! @param  others      The other symbols.
+//!
+//! @throws std::invalid_argument if a symbol appears twice or is '\0', or if there are no symbols.
+Alphabet::Alphabet(std::string_view vowels, std::string_view consonants, std::string_view others)
+{
+    classes.fill(SymbolClass::Other);
+    for (char c : vowels)
+    {
+        add(c, SymbolClass::Vowel);
+    }
+    for (char c : consonants)
+    {
+        add(c, SymbolClass::Consonant);
+    }
+    for (char c : others)
+    {
+        add(c, SymbolClass::Other);
+    }
+    finish();
+}
+
+//! @return The alphabet of VOWELS and CONSONANTS.
+Alphabet const & Alphabet::english()
+{
+    static Alphabet const alphabet;
+    return alphabet;
+}
+
+//! @param  path    Path of the file.
+//!
+//! @return The alphabet.
+//!
+//! @throws std::runtime_error if the file cannot be read or is not valid.
+Alphabet Alphabet::load(std::string const & path)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Cannot open alphabet file: " + path);
+    }
+
+    std::string vowels;
+    std::string consonants;
+    std::string others;
+    std::string line;
+    for (size_t lineNumber = 1; std::getline(file, line); ++lineNumber)
+    {
+        std::istringstream fields(line);
+        std::string        label;
+        std::string        symbols;
+        if (!(fields >> label) || label[0] == '#')
+        {
+            continue;
+        }
+        std::string extra;
+        if (!(fields >> symbols) || (fields >> extra))
+        {
+            throw std::runtime_error(path + ":" + std::to_string(lineNumber) + ": expected a class label and its symbols");
+        }
+        if (label == "vowel")
+        {
+            vowels += symbols;
+        }
+        else if (label == "consonant")
+        {
+            consonants += symbols;
+        }
+        else if (label == "other")
+        {
+            others += symbols;
+        }
+        else
+        {
+            throw std::runtime_error(path + ":" + std::to_string(lineNumber) + ": unknown class label: " + label);
+        }
+    }
+
+    try
+    {
+        return Alphabet(vowels, consonants, others);
+    }
+    catch (std::invalid_argument const & e)
+    {
+        throw std::runtime_error(path + ": " + e.what());
+    }
+}
+
+//! @param  words   The words.
+//! @param  base    The alphabet to extend.
+//!
+//! @return The extended alphabet.
+Alphabet Alphabet::fromWords(WordList const & words, Alphabet const & base)
+{
+    std::array<bool, 256> seen{};
+    for (auto const & [word, weight] : words)
+    {
+        for (char c : word)
+        {
+            seen[static_cast<unsigned char>(c)] = true;
+        }
+    }
+
+    Alphabet result = base;
+    for (unsigned c = 1; c < seen.size(); ++c)
+    {
+        if (seen[c] && base.code(static_cast<char>(c)) == 0)
+        {
+            result.add(static_cast<char>(c), SymbolClass::Other);
+        }
+    }
+    result.finish();
+    return result;
+}
+
+//! @param  symbolClass The class.
+//!
+//! @return The symbols of the class.
+std::string Alphabet::symbolsOf(SymbolClass symbolClass) const
+{
+    std::string result;
+    std::copy_if(symbols.begin(),
+                 symbols.end(),
+                 std::back_inserter(result),
+                 [&](char c) { return classes[static_cast<unsigned char>(c)] == symbolClass; });
+    return result;
+}
+
+//! The special sequences are only checked if the alphabet lacks one of their replacement symbols.
+//!
+//! @param  word    The word to check.
+//!
+//! @return true if every n-gram of the word can be packed.
+bool Alphabet::isPackable(std::string_view word) const
+{
+    if (!std::all_of(word.begin(), word.end(), [this](char c) { return code(c) != 0; }))
+    {
+        return false;
+    }
+    if (replaced)
+    {
+        return true;
+    }
+    std::string const normalized = replaceSpecialSequences(word);
+    return std::all_of(normalized.begin(), normalized.end(), [this](char c) { return code(c) != 0; });
+}
+
+//! @param  ngram   A normalized n-gram.
+//!
+//! @return The key, or 0 if the n-gram cannot be packed.
+NGramKey Alphabet::pack(std::string_view ngram) const
+{
+    if (ngram.empty() || ngram.size() > maxLength)
+    {
+        return 0;
+    }
+
+    NGramKey key = 0;
+    for (char c : ngram)
+    {
+        unsigned symbolCode = code(c);
+        if (symbolCode == 0)
+        {
+            return 0;
+        }
+        key = (key << bits) | symbolCode;
+    }
+    return key;
+}
+
+//! @param  key A key created by pack().
+//!
+//! @return The n-gram.
+std::string Alphabet::unpack(NGramKey key) const
+{
+    std::string ngram(packedLength(key), '\0');
+    for (auto it = ngram.rbegin(); it != ngram.rend(); ++it)
+    {
+        *it = symbols[static_cast<size_t>(key & ((NGramKey(1) << bits) - 1)) - 1];
+        key >>= bits;
+    }
+    return ngram;
+}
+
+//! @param  key A packed n-gram.
+//!
+//! @return The number of symbols in the n-gram.
+size_t Alphabet::packedLength(NGramKey key) const
+{
+    size_t length = 0;
+    for (; key != 0; key >>= bits)
+    {
+        ++length;
+    }
+    return length;
+}
+
+//! @param  symbol      The symbol.
+//! @param  symbolClass The class of the symbol.
+//!
+//! @throws std::invalid_argument if the symbol is '\0' or is already a symbol.
+void Alphabet::add(char symbol, SymbolClass symbolClass)
+{
+    if (symbol == '\0')
+    {
+        throw std::invalid_argument("An alphabet symbol cannot be '\\0'.");
+    }
+    if (code(symbol) != 0)
+    {
+        throw std::invalid_argument(std::string("Duplicate alphabet symbol: ") + symbol);
+    }
+    symbols.push_back(symbol);
+    codes[static_cast<unsigned char>(symbol)]   = static_cast<uint8_t>(symbols.size());
+    classes[static_cast<unsigned char>(symbol)] = symbolClass;
+}
+
+//! @throws std::invalid_argument if there are no symbols.
+void Alphabet::finish()
+{
+    if (symbols.empty())
+    {
+        throw std::invalid_argument("An alphabet must have at least one symbol.");
+    }
+
+    // The codes go from 1 to size(), and 0 is never a code
+    bits = 1;
+    while ((size_t(1) << bits) <= symbols.size())
+    {
+        ++bits;
+    }
+    maxLength = (sizeof(NGramKey) * 8) / bits;
+    replaced  = code('Q') != 0 && code('Y') != 0 && code('W') != 0;
+}
+
+//! @param  counts      The counts to extract from.
+//! @param  alphabet    The alphabet whose classes are used.
+//!
+//! @return The vowel-only and consonant-only n-grams.
+VowelConsonantNGrams extractVowelConsonantNGrams(NGramCounts const & counts, Alphabet const & alphabet)
+{
+    VowelConsonantNGrams result;
+    std::string const    vowels     = alphabet.symbolsOf(SymbolClass::Vowel);
+    std::string const    consonants = alphabet.symbolsOf(SymbolClass::Consonant);
+    for (auto const & ngram_map : counts.ngramMaps)
+    {
+        for (auto const & [ngram, weight] : ngram_map)
+        {
+            if (ngram.find_first_not_of(vowels) == std::string_view::npos)
+            {
+                result.vowels[ngram] = weight;
+                result.totalVowels += weight;
+            }
+            else if (ngram.find_first_not_of(consonants) == std::string_view::npos)
+            {
+                result.consonants[ngram] = weight;
+                result.totalConsonants += weight;
+            }
+        }
+    }
+    return result;
+}
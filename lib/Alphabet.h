@@ -0,0 +1,110 @@
+#pragma once
+
+#include "NGramCounts.h"
+#include "NGramKey.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+
+//! Class of a symbol of an Alphabet.
+enum class SymbolClass
+{
+    Vowel,     //!< A vowel
+    Consonant, //!< A consonant
+    Other      //!< Neither, such as an apostrophe or a digit
+};
+
+//! The symbols that n-grams are made of, each with a class label, and their packed-key encoding.
+//!
+//! Symbols are single characters. They are numbered from 1 in the order they were added, and an n-gram is packed like an
+//! NGramKey, with each symbol taking the fewest bits that hold the largest code, so a small alphabet packs longer n-grams
+//! into a key. The default alphabet is the normalized English alphabet (VOWELS and CONSONANTS), whose encoding is the
+//! one of packNGram(). Words are normalized by replaceSpecialSequences() whatever the alphabet.
+class Alphabet
+{
+public:
+    //! Constructs the normalized English alphabet.
+    Alphabet();
+
+    //! Constructs an alphabet from its symbols, numbered in order: the vowels, the consonants and then the other symbols.
+    //!
+    //! @throws std::invalid_argument if a symbol appears twice or is '\0', or if there are no symbols.
+    Alphabet(std::string_view vowels, std::string_view consonants, std::string_view others = "");
+
+    //! Returns the normalized English alphabet.
+    static Alphabet const & english();
+
+    //! Loads an alphabet from a file.
+    //!
+    //! Each line holds a class label (vowel, consonant or other) and the symbols of that class, without separators. Lines
+    //! may repeat a label. Empty lines and lines starting with '#' are ignored.
+    //!
+    //! @throws std::runtime_error if the file cannot be read or is not valid.
+    static Alphabet load(std::string const & path);
+
+    //! Returns an alphabet that extends a base alphabet with every other character of a list of words, in byte order, as
+    //! symbols of class Other.
+    static Alphabet fromWords(WordList const & words, Alphabet const & base = english());
+
+    //! Returns the number of symbols.
+    size_t size() const { return symbols.size(); }
+
+    //! Returns the number of bits of each symbol in a packed key.
+    unsigned symbolBits() const { return bits; }
+
+    //! Returns the length of the longest n-gram that can be packed.
+    size_t maxPackedLength() const { return maxLength; }
+
+    //! Returns the symbols of a class, in code order.
+    std::string symbolsOf(SymbolClass symbolClass) const;
+
+    //! Returns the code of a character, from 1 to size(), or 0 if it is not a symbol.
+    unsigned code(char c) const { return codes[static_cast<unsigned char>(c)]; }
+
+    //! Returns the class of a symbol. Characters that are not symbols are of class Other.
+    SymbolClass symbolClass(char c) const { return classes[static_cast<unsigned char>(c)]; }
+
+    //! Returns true if every n-gram of a word can be packed, that is if every character of the word, and every symbol its
+    //! special sequences are replaced with, is a symbol.
+    bool isPackable(std::string_view word) const;
+
+    //! Packs a normalized n-gram into a key.
+    //!
+    //! @return The key, or 0 if the n-gram is empty, too long, or contains a character that is not a symbol.
+    NGramKey pack(std::string_view ngram) const;
+
+    //! Unpacks a key created by pack().
+    std::string unpack(NGramKey key) const;
+
+    //! Returns the number of symbols in a packed n-gram.
+    size_t packedLength(NGramKey key) const;
+
+    //! Calls a visitor for the normalized form of every substring of a word, packed with this alphabet. See
+    //! forEachNormalizedNGram(), which this is for the English alphabet. The word must be packable (see isPackable()).
+    template <typename Visitor>
+    void forEachNormalizedNGram(std::string_view word, Visitor && visit) const
+    {
+        NGramKeyDetail::walkNormalizedNGrams(word, codes.data(), bits, maxLength, std::forward<Visitor>(visit));
+    }
+
+private:
+    // Adds a symbol
+    void add(char symbol, SymbolClass symbolClass);
+
+    // Computes the packing from the symbols
+    void finish();
+
+    std::string                  symbols;          // The symbols, in code order
+    std::array<uint8_t, 256>     codes{};          // Code of each character, or 0
+    std::array<SymbolClass, 256> classes{};        // Class of each character
+    unsigned                     bits      = 0;    // Bits of each symbol in a key
+    size_t                       maxLength = 0;    // Longest n-gram that can be packed
+    bool                         replaced  = true; // True if 'Q', 'Y' and 'W' are all symbols
+};
+
+//! Extracts the n-grams made only of vowels or only of consonants of an alphabet from a set of counts.
+VowelConsonantNGrams extractVowelConsonantNGrams(NGramCounts const & counts, Alphabet const & alphabet);
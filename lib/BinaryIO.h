@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Helpers for reading and writing the binary files produced by the library. Values are stored in native byte order.
+
+//! Writes a trivially-copyable value to a binary stream.
+template <typename T>
+void writeBinary(std::ostream & out, T const & value)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    out.write(reinterpret_cast<char const *>(&value), sizeof(T));
+}
+
+//! Reads a trivially-copyable value from a binary stream.
+//!
+//! @throws std::runtime_error if the stream ends before the value is read.
+template <typename T>
+T readBinary(std::istream & in)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    T value;
+    if (!in.read(reinterpret_cast<char *>(&value), sizeof(T)))
+    {
+        throw std::runtime_error("Unexpected end of binary data.");
+    }
+    return value;
+}
+
+//! Returns the number of bytes left to read in a binary stream, or the largest uint64_t if the stream cannot tell, such as
+//! a pipe. Readers bound the counts they read with it, so that a corrupt count fails before anything is allocated for it.
+inline uint64_t remainingBytes(std::istream & in)
+{
+    uint64_t const       unknown  = std::numeric_limits<uint64_t>::max();
+    std::streampos const position = in.tellg();
+    if (position < 0)
+    {
+        return unknown;
+    }
+    in.seekg(0, std::ios::end);
+    std::streampos const end = in.tellg();
+    in.clear(in.rdstate() & ~std::ios::failbit);
+    in.seekg(position);
+    return (end < position) ? unknown : static_cast<uint64_t>(end - position);
+}
+
+//! Writes a length-prefixed string to a binary stream.
+inline void writeBinaryString(std::ostream & out, std::string_view s)
+{
+    writeBinary<uint32_t>(out, static_cast<uint32_t>(s.size()));
+    out.write(s.data(), static_cast<std::streamsize>(s.size()));
+}
+
+//! Reads a length-prefixed string written by writeBinaryString().
+//!
+//! @throws std::runtime_error if the stream ends before the string is read.
+inline std::string readBinaryString(std::istream & in)
+{
+    std::string s(readBinary<uint32_t>(in), '\0');
+    if (!in.read(s.data(), static_cast<std::streamsize>(s.size())))
+    {
+        throw std::runtime_error("Unexpected end of binary data.");
+    }
+    return s;
+}
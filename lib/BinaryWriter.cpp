@@ -0,0 +1,190 @@
+#include "BinaryWriter.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+//! @param  x   The integer.
+template <typename T>
+void BinaryWriter::appendBigEndian(T x)
+{
+    char bytes[sizeof(T)];
+    for (size_t i = sizeof(T); i > 0; --i)
+    {
+        bytes[i - 1] = static_cast<char>(x & 0xff);
+        x >>= 8;
+    }
+    output.append(std::string_view(bytes, sizeof(T)));
+}
+
+//! The argument is written in the item's first byte if it is less than 24, and in the fewest of 1, 2, 4 or 8 following
+//! bytes otherwise.
+//!
+//! @param  majorType   The major type, from 0 to 7.
+//! @param  argument    The argument: a value, or a length.
+void BinaryWriter::appendCborHeader(uint8_t majorType, uint64_t argument)
+{
+    char const type = static_cast<char>(majorType << 5);
+    if (argument < 24)
+    {
+        output.append(static_cast<char>(type | static_cast<char>(argument)));
+    }
+    else if (argument <= std::numeric_limits<uint8_t>::max())
+    {
+        output.append(static_cast<char>(type | 24));
+        appendBigEndian(static_cast<uint8_t>(argument));
+    }
+    else if (argument <= std::numeric_limits<uint16_t>::max())
+    {
+        output.append(static_cast<char>(type | 25));
+        appendBigEndian(static_cast<uint16_t>(argument));
+    }
+    else if (argument <= std::numeric_limits<uint32_t>::max())
+    {
+        output.append(static_cast<char>(type | 26));
+        appendBigEndian(static_cast<uint32_t>(argument));
+    }
+    else
+    {
+        output.append(static_cast<char>(type | 27));
+        appendBigEndian(argument);
+    }
+}
+
+//! @param  fixed       The fixed form, which holds sizes below fixedLimit in its low bits.
+//! @param  fixedLimit  The smallest size that the fixed form cannot hold.
+//! @param  first       The first of the forms with a separate size.
+//! @param  has8Bit     True if the forms with a separate size start with an 8-bit size.
+//! @param  size        The number of members, items or bytes.
+void BinaryWriter::appendMessagePackHeader(uint8_t fixed, size_t fixedLimit, uint8_t first, bool has8Bit, size_t size)
+{
+    if (size < fixedLimit)
+    {
+        output.append(static_cast<char>(fixed | size));
+        return;
+    }
+    uint8_t form = first;
+    if (has8Bit)
+    {
+        if (size <= std::numeric_limits<uint8_t>::max())
+        {
+            output.append(static_cast<char>(form));
+            appendBigEndian(static_cast<uint8_t>(size));
+            return;
+        }
+        ++form;
+    }
+    if (size <= std::numeric_limits<uint16_t>::max())
+    {
+        output.append(static_cast<char>(form));
+        appendBigEndian(static_cast<uint16_t>(size));
+        return;
+    }
+    output.append(static_cast<char>(form + 1));
+    appendBigEndian(static_cast<uint32_t>(size));
+}
+
+//! @param  members The number of members.
+void BinaryWriter::beginObject(size_t members)
+{
+    if (format == BinaryFormat::Cbor)
+    {
+        appendCborHeader(5, members);
+    }
+    else
+    {
+        appendMessagePackHeader(0x80, 16, 0xde, false, members);
+    }
+}
+
+//! @param  items   The number of items.
+void BinaryWriter::beginArray(size_t items)
+{
+    if (format == BinaryFormat::Cbor)
+    {
+        appendCborHeader(4, items);
+    }
+    else
+    {
+        appendMessagePackHeader(0x90, 16, 0xdc, false, items);
+    }
+}
+
+//! @param  s   The string.
+void BinaryWriter::value(std::string_view s)
+{
+    if (format == BinaryFormat::Cbor)
+    {
+        appendCborHeader(3, s.size());
+    }
+    else
+    {
+        appendMessagePackHeader(0xa0, 32, 0xd9, true, s.size());
+    }
+    output.append(s);
+}
+
+//! CBOR has special half-precision forms for NaN and the infinities.
+//!
+//! @param  x   The double.
+void BinaryWriter::value(double x)
+{
+    bool const cbor = format == BinaryFormat::Cbor;
+    if (cbor && !std::isfinite(x))
+    {
+        output.append(std::string_view(std::isnan(x) ? "\xf9\x7e\x00" : (x > 0.0) ? "\xf9\x7c\x00" : "\xf9\xfc\x00", 3));
+        return;
+    }
+
+    float const narrow = static_cast<float>(x);
+    if (std::fabs(x) <= static_cast<double>(std::numeric_limits<float>::max()) && static_cast<double>(narrow) == x)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &narrow, sizeof(bits));
+        output.append(static_cast<char>(cbor ? 0xfa : 0xca));
+        appendBigEndian(bits);
+    }
+    else
+    {
+        uint64_t bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+        output.append(static_cast<char>(cbor ? 0xfb : 0xcb));
+        appendBigEndian(bits);
+    }
+}
+
+//! @param  x   The integer.
+void BinaryWriter::value(uint64_t x)
+{
+    if (format == BinaryFormat::Cbor)
+    {
+        appendCborHeader(0, x);
+        return;
+    }
+
+    // A positive fixint, or the fewest bytes of uint 8, 16, 32 or 64
+    if (x < 128)
+    {
+        output.append(static_cast<char>(x));
+    }
+    else if (x <= std::numeric_limits<uint8_t>::max())
+    {
+        output.append(static_cast<char>(0xcc));
+        appendBigEndian(static_cast<uint8_t>(x));
+    }
+    else if (x <= std::numeric_limits<uint16_t>::max())
+    {
+        output.append(static_cast<char>(0xcd));
+        appendBigEndian(static_cast<uint16_t>(x));
+    }
+    else if (x <= std::numeric_limits<uint32_t>::max())
+    {
+        output.append(static_cast<char>(0xce));
+        appendBigEndian(static_cast<uint32_t>(x));
+    }
+    else
+    {
+        output.append(static_cast<char>(0xcf));
+        appendBigEndian(x);
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "OutputBuffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+
+//! Binary document formats written by a BinaryWriter.
+enum class BinaryFormat
+{
+    Cbor,       //!< CBOR (RFC 8949)
+    MessagePack //!< MessagePack
+};
+
+//! Writes a CBOR or MessagePack document to a stream as it is produced.
+//!
+//! It has the interface of JsonWriter, so the same code writes either. Both formats put the number of members of an object
+//! or the number of items of an array before them, so beginObject() and beginArray() must be given the exact number. The
+//! encoding is the one of nlohmann::json::to_cbor() and to_msgpack(). Each header and integer takes the fewest bytes,
+//! big-endian. A double that a float holds exactly is written as a float. Strings are written as they are, so keys must
+//! be given in increasing order to get the same bytes (see writeSortedObject()).
+class BinaryWriter
+{
+public:
+    //! Constructs a writer that writes a format to a stream.
+    BinaryWriter(std::ostream & out, BinaryFormat format, size_t bufferSize = OUTPUT_BUFFER_SIZE)
+        : output(out, bufferSize)
+        , format(format)
+    {
+    }
+
+    //! Constructs a writer that writes items of another writer's document to another stream, in the same format. See
+    //! writeItemsOrdered().
+    BinaryWriter(std::ostream & out, BinaryWriter const & parent, size_t previousItems, size_t bufferSize = OUTPUT_BUFFER_SIZE)
+        : output(out, bufferSize)
+        , format(parent.format)
+    {
+        static_cast<void>(previousItems);
+    }
+
+    //! Opens an object with the specified number of members.
+    void beginObject(size_t members);
+
+    //! Closes the innermost object. Nothing is written.
+    void endObject() {}
+
+    //! Opens an array with the specified number of items.
+    void beginArray(size_t items);
+
+    //! Closes the innermost array. Nothing is written.
+    void endArray() {}
+
+    //! Writes the key of the next member of the innermost object.
+    void key(std::string_view name) { value(name); }
+
+    //! Writes a string.
+    void value(std::string_view s);
+
+    //! Writes a double.
+    void value(double x);
+
+    //! Writes an unsigned integer.
+    void value(uint64_t x);
+
+    //! Records that items of the innermost array were written by writers continuing this one. Nothing is needed, since
+    //! the number of items was written when the array was opened.
+    void skipItems(size_t items) { static_cast<void>(items); }
+
+    //! Writes the buffered output to the stream.
+    void flush() { output.flush(); }
+
+private:
+    // Appends an integer in big-endian byte order
+    template <typename T>
+    void appendBigEndian(T x);
+
+    // Appends the header of a CBOR item: a major type and its argument
+    void appendCborHeader(uint8_t majorType, uint64_t argument);
+
+    // Appends the header of a MessagePack container or string, given its fixed form and the first of its 8-, 16- and
+    // 32-bit forms (or its 16- and 32-bit forms if it has no 8-bit form)
+    void appendMessagePackHeader(uint8_t fixed, size_t fixedLimit, uint8_t first, bool has8Bit, size_t size);
+
+    OutputBuffer output; // The buffered output
+    BinaryFormat format; // The format written
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+//! A first-in first-out queue shared by producer and consumer threads, holding at most a fixed number of items.
+//!
+//! push() waits while the queue is full, so a fast producer cannot run arbitrarily far ahead of its consumers, and pop()
+//! waits while it is empty. Once the queue is closed, push() discards its item and pop() returns the remaining items and then
+//! nothing.
+template <typename T>
+class BoundedQueue
+{
+public:
+    //! Constructs an empty queue holding at most the specified number of items (at least 1).
+    explicit BoundedQueue(size_t capacity)
+        : capacity(capacity > 0 ? capacity : 1)
+    {
+    }
+
+    //! Adds an item to the back of the queue, waiting until there is room. Returns false if the queue is closed.
+    bool push(T item)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        notFull.wait(lock, [this] { return closed || items.size() < capacity; });
+        if (closed)
+        {
+            return false;
+        }
+        items.push_back(std::move(item));
+        notEmpty.notify_one();
+        return true;
+    }
+
+    //! Removes the item at the front of the queue, waiting until there is one. Returns nothing once the queue is closed and
+    //! empty.
+    std::optional<T> pop()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        notEmpty.wait(lock, [this] { return closed || !items.empty(); });
+        if (items.empty())
+        {
+            return std::nullopt;
+        }
+        T item = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return item;
+    }
+
+    //! Closes the queue, waking every waiting thread. Items already in the queue can still be popped.
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        notFull.notify_all();
+        notEmpty.notify_all();
+    }
+
+private:
+    size_t                  capacity;       // Maximum number of items
+    bool                    closed = false; // No more items will be pushed
+    std::deque<T>           items;          // The items, front first
+    std::mutex              mutex;          // Guards closed and items
+    std::condition_variable notFull;        // Signaled when an item is popped or the queue is closed
+    std::condition_variable notEmpty;       // Signaled when an item is pushed or the queue is closed
+};
@@ -0,0 +1,151 @@
+#include "Checkpoint.h"
+
+#include "BinaryIO.h"
+
+#include <cerrno>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#if defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+// Identifies a checkpoint file
+uint32_t const CHECKPOINT_MAGIC   = 0x54504b43; // "CKPT"
+uint32_t const CHECKPOINT_VERSION = 1;
+
+// Writes a file's data to the storage device, so that it survives a crash. Returns false on failure.
+bool syncFile(std::string const & path)
+{
+#if defined(_WIN32)
+    int const fd = ::_open(path.c_str(), _O_WRONLY | _O_BINARY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    bool const synced = ::_commit(fd) == 0;
+    ::_close(fd);
+    return synced;
+#else
+    int const fd = ::open(path.c_str(), O_WRONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    bool const synced = ::fsync(fd) == 0;
+    ::close(fd);
+    return synced;
+#endif
+}
+
+// Writes a directory's entries to the storage device, so that a file renamed into it survives a crash. Returns false on
+// failure. Windows has no way to do this, and file systems that cannot sync directories do not need to.
+bool syncDirectory(std::string const & path)
+{
+#if defined(_WIN32)
+    (void)path;
+    return true;
+#else
+    int const fd = ::open(path.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    bool const synced = ::fsync(fd) == 0 || errno == EINVAL;
+    ::close(fd);
+    return synced;
+#endif
+}
+
+} // anonymous namespace
+
+//! The checkpoint is written to a temporary file which is then renamed over the destination, so the file at the path is
+//! always a complete checkpoint even if the program is interrupted while saving. The temporary file is synced to the
+//! storage device before the rename, and its directory after it, so that a crash of the system cannot leave a truncated
+//! checkpoint or lose the rename either.
+//!
+//! @param  path    Path of the checkpoint file.
+//!
+//! @throws std::runtime_error if the checkpoint cannot be written.
+void Checkpoint::save(std::string const & path) const
+{
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+        {
+            throw std::runtime_error("Cannot create checkpoint file: " + tempPath);
+        }
+        writeBinary(out, CHECKPOINT_MAGIC);
+        writeBinary(out, CHECKPOINT_VERSION);
+        writeBinary(out, position);
+        writeBinary(out, processedWeight);
+        writeBinary(out, inputWords);
+        writeBinary(out, inputWeight);
+        counts.write(out);
+        out.flush();
+        if (!out)
+        {
+            throw std::runtime_error("Failed to write checkpoint file: " + tempPath);
+        }
+    }
+    if (!syncFile(tempPath))
+    {
+        throw std::runtime_error("Failed to sync checkpoint file: " + tempPath);
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempPath, path, error);
+    if (error)
+    {
+        throw std::runtime_error("Failed to replace checkpoint file " + path + ": " + error.message());
+    }
+
+    std::filesystem::path const directory = std::filesystem::path(path).parent_path();
+    if (!syncDirectory(directory.empty() ? "." : directory.string()))
+    {
+        throw std::runtime_error("Failed to sync the directory of checkpoint file: " + path);
+    }
+}
+
+//! @param  path    Path of the checkpoint file.
+//!
+//! @return The checkpoint.
+//!
+//! @throws std::runtime_error if the file cannot be opened or is not a valid checkpoint.
+Checkpoint Checkpoint::load(std::string const & path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open())
+    {
+        throw std::runtime_error("Cannot open checkpoint file: " + path);
+    }
+
+    try
+    {
+        if (readBinary<uint32_t>(in) != CHECKPOINT_MAGIC || readBinary<uint32_t>(in) != CHECKPOINT_VERSION)
+        {
+            throw std::runtime_error("not a checkpoint file, or an unsupported version");
+        }
+        Checkpoint checkpoint;
+        checkpoint.position        = readBinary<uint64_t>(in);
+        checkpoint.processedWeight = readBinary<double>(in);
+        checkpoint.inputWords      = readBinary<uint64_t>(in);
+        checkpoint.inputWeight     = readBinary<double>(in);
+        checkpoint.counts          = NGramCounts::read(in);
+        return checkpoint;
+    }
+    catch (std::exception const & e)
+    {
+        throw std::runtime_error("Invalid checkpoint file " + path + ": " + e.what());
+    }
+}
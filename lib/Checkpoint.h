@@ -0,0 +1,35 @@
+#pragma once
+
+#include "NGramCounts.h"
+
+#include <cstdint>
+#include <string>
+
+//! Counting state that is saved periodically so that an interrupted run can be resumed.
+//!
+//! The words of the input are counted in a fixed order, so the state is the partial counts plus the position of the next
+//! word to count. The size and total weight of the input are recorded so that a checkpoint is not resumed against different
+//! input.
+//!
+//! Example usage:
+//! @code
+//! Checkpoint checkpoint = Checkpoint::load("run.ckpt");
+//! for (size_t i = checkpoint.position; i < words.size(); ++i) {
+//!     checkpoint.counts.addWord(words[i].first, words[i].second);
+//!     ...
+//! }
+//! @endcode
+struct Checkpoint
+{
+    NGramCounts counts;                //!< Partial counts
+    uint64_t    position        = 0;   //!< Index of the next word to count
+    double      processedWeight = 0.0; //!< Total weight of the words counted so far
+    uint64_t    inputWords      = 0;   //!< Number of words in the input
+    double      inputWeight     = 0.0; //!< Total weight of the words in the input
+
+    //! Saves the checkpoint atomically, replacing any previous checkpoint at the same path.
+    void save(std::string const & path) const;
+
+    //! Loads a checkpoint saved by save().
+    static Checkpoint load(std::string const & path);
+};
@@ -0,0 +1,129 @@
+#include "CountMinSketch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+
+// Limits of the width chosen by widthFor()
+size_t const MIN_WIDTH = size_t(1) << 10;
+size_t const MAX_WIDTH = size_t(1) << 20;
+
+// Mixes the bits of a value (the splitmix64 finalizer)
+uint64_t mix(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+}
+
+} // anonymous namespace
+
+//! @param  width   Number of cells in each row.
+//! @param  depth   Number of rows.
+//!
+//! @throws std::invalid_argument if width or depth is 0.
+CountMinSketch::CountMinSketch(size_t width, size_t depth)
+    : width(1)
+    , depth(depth)
+    , shift(64)
+{
+    if (width == 0 || depth == 0)
+    {
+        throw std::invalid_argument("Count-Min sketch dimensions must be positive.");
+    }
+    while (this->width < std::max<size_t>(width, 2))
+    {
+        this->width *= 2;
+        --shift;
+    }
+    cells = std::vector<std::atomic<double>>(this->width * depth);
+    for (auto & c : cells)
+    {
+        c.store(0.0, std::memory_order_relaxed);
+    }
+}
+
+//! @param  totalWeight Total weight of the items that will be added.
+//! @param  maxError    Largest acceptable overestimate.
+//! @param  maxItems    Number of items that will be added (counting repeated items each time).
+//!
+//! @return The width, a power of two.
+size_t CountMinSketch::widthFor(double totalWeight, double maxError, size_t maxItems)
+{
+    double width = (maxError > 0.0) ? std::exp(1.0) * totalWeight / maxError : std::numeric_limits<double>::infinity();
+    width        = std::min(width, static_cast<double>(maxItems));
+    size_t result = MIN_WIDTH;
+    while (result < MAX_WIDTH && result < width)
+    {
+        result *= 2;
+    }
+    return result;
+}
+
+//! @param  fingerprint Identifies the item.
+//! @param  weight      Weight to add.
+void CountMinSketch::add(uint64_t fingerprint, double weight)
+{
+    for (size_t row = 0; row < depth; ++row)
+    {
+        std::atomic<double> & c = cells[row * width + cell(fingerprint, row)];
+        c.store(c.load(std::memory_order_relaxed) + weight, std::memory_order_relaxed);
+    }
+}
+
+//! @param  fingerprint Identifies the item.
+//! @param  weight      Weight to add.
+void CountMinSketch::addConcurrently(uint64_t fingerprint, double weight)
+{
+    for (size_t row = 0; row < depth; ++row)
+    {
+        // The order of the adds does not matter, so relaxed ordering is enough
+        std::atomic<double> & c   = cells[row * width + cell(fingerprint, row)];
+        double                sum = c.load(std::memory_order_relaxed);
+        while (!c.compare_exchange_weak(sum, sum + weight, std::memory_order_relaxed))
+        {
+        }
+    }
+}
+
+//! @param  fingerprint Identifies the item.
+//!
+//! @return The estimated weight, which is at least the true weight.
+double CountMinSketch::estimate(uint64_t fingerprint) const
+{
+    double result = std::numeric_limits<double>::infinity();
+    for (size_t row = 0; row < depth; ++row)
+    {
+        result = std::min(result, cells[row * width + cell(fingerprint, row)].load(std::memory_order_relaxed));
+    }
+    return result;
+}
+
+//! @param  other   A sketch with the same width and depth.
+//!
+//! @throws std::invalid_argument if the sketches have different dimensions.
+void CountMinSketch::merge(CountMinSketch const & other)
+{
+    if (other.width != width || other.depth != depth)
+    {
+        throw std::invalid_argument("Cannot merge Count-Min sketches of different dimensions.");
+    }
+    for (size_t i = 0; i < cells.size(); ++i)
+    {
+        cells[i].store(cells[i].load(std::memory_order_relaxed) + other.cells[i].load(std::memory_order_relaxed),
+                       std::memory_order_relaxed);
+    }
+}
+
+size_t CountMinSketch::cell(uint64_t fingerprint, size_t row) const
+{
+    // Each row uses a different seed, so the rows hash independently
+    return static_cast<size_t>(mix(fingerprint + 0x9e3779b97f4a7c15ull * (row + 1)) >> shift);
+}
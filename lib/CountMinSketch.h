@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//! Count-Min sketch of weighted items.
+//!
+//! Items are identified by 64-bit fingerprints. Each of the sketch's rows hashes a fingerprint to one of its cells, and the
+//! estimated weight of an item is the smallest of its cells. The estimate is never less than the item's true weight, and
+//! with probability 1 - e^-depth it exceeds the true weight by at most e / width times the total weight of all items.
+//!
+//! Several threads can add to the same sketch at once with addConcurrently(), so a sketch shared by every thread takes no
+//! more memory than one.
+class CountMinSketch
+{
+public:
+    //! Constructs an empty sketch. The width is rounded up to a power of two.
+    CountMinSketch(size_t width, size_t depth);
+
+    //! Returns the width needed so that estimates exceed the true weights by at most maxError (with high probability).
+    //!
+    //! The width is limited to the number of items added, beyond which a wider sketch does not help, and to a fixed maximum.
+    static size_t widthFor(double totalWeight, double maxError, size_t maxItems);
+
+    //! Adds a weight to an item.
+    void add(uint64_t fingerprint, double weight);
+
+    //! Adds a weight to an item. Unlike add(), several threads can call it at the same time.
+    void addConcurrently(uint64_t fingerprint, double weight);
+
+    //! Returns the number of rows.
+    size_t rows() const { return depth; }
+
+    //! Returns an upper bound of the weight of an item.
+    double estimate(uint64_t fingerprint) const;
+
+    //! Adds the weights of another sketch of the same dimensions to this sketch.
+    void merge(CountMinSketch const & other);
+
+    //! Returns the size of the sketch in bytes.
+    size_t bytes() const { return cells.size() * sizeof(double); }
+
+private:
+    // Returns the index of an item's cell in a row
+    size_t cell(uint64_t fingerprint, size_t row) const;
+
+    size_t                           width; // Number of cells in each row, a power of two
+    size_t                           depth; // Number of rows
+    unsigned                         shift; // 64 - log2(width)
+    std::vector<std::atomic<double>> cells; // depth rows of width cells
+};
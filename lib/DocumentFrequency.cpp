@@ -0,0 +1,294 @@
+#include "DocumentFrequency.h"
+
+#include "Alphabet.h"
+#include "NGramKey.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <iterator>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+
+namespace
+{
+
+// Occurrence weight and document frequency of an n-gram, in one table entry
+struct FrequencyEntry
+{
+    NGramKey key         = 0;   // The packed n-gram, or 0 if the slot is empty
+    double   weight      = 0.0; // Total weight of the occurrences
+    uint64_t words       = 0;   // Number of distinct words containing the n-gram
+    double   wordsWeight = 0.0; // Total weight of those words
+};
+
+// Open-addressing hash table of FrequencyEntry, laid out like NGramTable
+class FrequencyTable
+{
+public:
+    FrequencyTable()
+        : slots(size_t(1) << 10)
+        , count(0)
+        , shift(64 - 10)
+    {
+    }
+
+    // Returns the entry of an n-gram, inserting it if necessary. The reference is valid until the next call.
+    FrequencyEntry & entry(NGramKey key)
+    {
+        size_t const mask = slots.size() - 1;
+        for (size_t i = home(key);; i = (i + 1) & mask)
+        {
+            if (slots[i].key == key)
+            {
+                return slots[i];
+            }
+            if (slots[i].key == 0)
+            {
+                if ((count + 1) * 2 > slots.size())
+                {
+                    grow();
+                    return entry(key);
+                }
+                ++count;
+                slots[i].key = key;
+                return slots[i];
+            }
+        }
+    }
+
+    template <typename Visitor>
+    void forEach(Visitor && visit) const
+    {
+        for (auto const & slot : slots)
+        {
+            if (slot.key != 0)
+            {
+                visit(slot);
+            }
+        }
+    }
+
+private:
+    size_t home(NGramKey key) const { return static_cast<size_t>((key * 0x9e3779b97f4a7c15ull) >> shift); }
+
+    void grow()
+    {
+        std::vector<FrequencyEntry> old = std::move(slots);
+        slots.assign(old.size() * 2, FrequencyEntry{});
+        --shift;
+        count = 0;
+        for (auto const & slot : old)
+        {
+            if (slot.key != 0)
+            {
+                entry(slot.key) = slot;
+            }
+        }
+    }
+
+    std::vector<FrequencyEntry> slots; // Power-of-two array of slots
+    size_t                      count; // Number of occupied slots
+    unsigned                    shift; // 64 - log2(number of slots)
+};
+
+// Set of the packed n-grams seen in the current word. Only the slots that were used are cleared between words, so the
+// cost of a word does not depend on the size of the set.
+class ScratchSet
+{
+public:
+    // Makes room for the n-grams of a word of the specified length and empties the set
+    void reset(size_t wordLength)
+    {
+        for (size_t i : used)
+        {
+            slots[i] = 0;
+        }
+        used.clear();
+
+        size_t const needed = std::max<size_t>(wordLength * (wordLength + 1), 16); // Twice the number of n-grams
+        if (slots.size() < needed)
+        {
+            size_t size = 16;
+            while (size < needed)
+            {
+                size *= 2;
+            }
+            slots.assign(size, 0);
+        }
+    }
+
+    // Adds an n-gram, returning true if it was not already in the set
+    bool insert(NGramKey key)
+    {
+        size_t const mask = slots.size() - 1;
+        for (size_t i = static_cast<size_t>(key * 0x9e3779b97f4a7c15ull >> 32) & mask;; i = (i + 1) & mask)
+        {
+            if (slots[i] == key)
+            {
+                return false;
+            }
+            if (slots[i] == 0)
+            {
+                slots[i] = key;
+                used.push_back(i);
+                return true;
+            }
+        }
+    }
+
+private:
+    std::vector<NGramKey> slots;
+    std::vector<size_t>   used; // Indices of the occupied slots
+};
+
+// Counts of one slice of the words
+struct SliceCounts
+{
+    FrequencyTable                    packed;      // The packed n-grams
+    NGramCounts                       unpacked;    // Weights of the other n-grams, and the total weights
+    std::vector<DocumentFrequencyMap> frequencies; // Document frequencies of the other n-grams
+};
+
+// Counts words[begin, end) into a slice, packing the n-grams with an alphabet
+void countSlice(SliceCounts & slice, WordList const & words, size_t begin, size_t end, Alphabet const & alphabet)
+{
+    ScratchSet                      seenPacked;
+    std::unordered_set<std::string> seenUnpacked;
+    for (size_t w = begin; w < end; ++w)
+    {
+        auto const & [word, weight] = words[w];
+        slice.unpacked.extend(word.size());
+        slice.frequencies.resize(slice.unpacked.ngramMaps.size());
+        seenPacked.reset(word.size());
+        seenUnpacked.clear();
+
+        auto const addUnpacked = [&](std::string ngram)
+        {
+            size_t const length = ngram.size();
+            slice.unpacked.ngramMaps[length][ngram] += weight;
+            slice.unpacked.totalWeights[length] += weight;
+            if (seenUnpacked.insert(ngram).second)
+            {
+                DocumentFrequency & frequency = slice.frequencies[length][std::move(ngram)];
+                frequency.words += 1;
+                frequency.weight += weight;
+            }
+        };
+
+        if (!alphabet.isPackable(word))
+        {
+            for (size_t n = 1; n <= word.size(); ++n)
+            {
+                for (size_t i = 0; i + n <= word.size(); ++i)
+                {
+                    addUnpacked(replaceSpecialSequences(std::string_view(word).substr(i, n)));
+                }
+            }
+            continue;
+        }
+
+        alphabet.forEachNormalizedNGram(
+            word,
+            [&](NGramKey key, size_t length, size_t start, size_t rawLength)
+            {
+                if (key == 0)
+                {
+                    addUnpacked(replaceSpecialSequences(std::string_view(word).substr(start, rawLength)));
+                    return;
+                }
+                slice.unpacked.totalWeights[length] += weight;
+                FrequencyEntry & entry = slice.packed.entry(key);
+                entry.weight += weight;
+                if (seenPacked.insert(key))
+                {
+                    entry.words += 1;
+                    entry.wordsWeight += weight;
+                }
+            });
+    }
+}
+
+} // anonymous namespace
+
+//! @param  counts              Counts to add to.
+//! @param  documentFrequencies Document frequencies to add to.
+//! @param  words               The words and their weights.
+//! @param  begin               Index of the first word to count.
+//! @param  end                 Index past the last word to count.
+//! @param  options             Counting options.
+void countDocumentFrequencies(NGramCounts &                       counts,
+                              std::vector<DocumentFrequencyMap> & documentFrequencies,
+                              WordList const &                    words,
+                              size_t                              begin,
+                              size_t                              end,
+                              CountingOptions const &             options)
+{
+    size_t const   count   = (end > begin) ? end - begin : 0;
+    unsigned const threads = static_cast<unsigned>(std::min<size_t>(std::max(options.threads, 1u), std::max<size_t>(count, 1)));
+
+    Alphabet const &         alphabet = options.alphabet ? *options.alphabet : Alphabet::english();
+    std::vector<SliceCounts> slices(threads);
+    runParallel(threads,
+                [&](unsigned t)
+                {
+                    countSlice(slices[t],
+                               words,
+                               begin + sliceBegin(count, t, threads),
+                               begin + sliceBegin(count, t + 1, threads),
+                               alphabet);
+                });
+
+    // Merge the slices in order into the counts of the range, unpacking the packed n-grams
+    NGramCounts                       rangeCounts;
+    std::vector<DocumentFrequencyMap> rangeFrequencies;
+    for (auto & slice : slices)
+    {
+        rangeCounts.merge(slice.unpacked);
+        rangeFrequencies.resize(rangeCounts.ngramMaps.size());
+        slice.packed.forEach(
+            [&](FrequencyEntry const & entry)
+            {
+                std::string  ngram  = alphabet.unpack(entry.key);
+                size_t const length = ngram.size();
+                rangeCounts.ngramMaps[length][ngram] += entry.weight;
+                DocumentFrequency & frequency = rangeFrequencies[length][std::move(ngram)];
+                frequency.words += entry.words;
+                frequency.weight += entry.wordsWeight;
+            });
+        for (size_t n = 0; n < slice.frequencies.size(); ++n)
+        {
+            for (auto const & [ngram, frequency] : slice.frequencies[n])
+            {
+                DocumentFrequency & merged = rangeFrequencies[n][ngram];
+                merged.words += frequency.words;
+                merged.weight += frequency.weight;
+            }
+        }
+    }
+
+    // The threshold applies to the occurrence weights of the range, and removes the same n-grams from both tables
+    if (options.minWeight > 0.0)
+    {
+        rangeCounts.prune(options.minWeight);
+        for (size_t n = 0; n < rangeFrequencies.size(); ++n)
+        {
+            for (auto it = rangeFrequencies[n].begin(); it != rangeFrequencies[n].end();)
+            {
+                it = (rangeCounts.ngramMaps[n].count(it->first) == 0) ? rangeFrequencies[n].erase(it) : std::next(it);
+            }
+        }
+    }
+
+    counts.merge(rangeCounts);
+    documentFrequencies.resize(std::max(documentFrequencies.size(), rangeFrequencies.size()));
+    for (size_t n = 0; n < rangeFrequencies.size(); ++n)
+    {
+        for (auto & [ngram, frequency] : rangeFrequencies[n])
+        {
+            DocumentFrequency & merged = documentFrequencies[n][ngram];
+            merged.words += frequency.words;
+            merged.weight += frequency.weight;
+        }
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "NGramCounter.h"
+#include "NGramCounts.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//! Document frequency of an n-gram: the words that contain it, each counted once however often it occurs in the word.
+struct DocumentFrequency
+{
+    uint64_t words  = 0;   //!< Number of distinct words containing the n-gram
+    double   weight = 0.0; //!< Total weight of the words containing the n-gram, each counted once
+
+    bool operator==(DocumentFrequency const & other) const { return words == other.words && weight == other.weight; }
+};
+
+//! Map of (n-gram, document frequency) pairs.
+typedef std::unordered_map<std::string, DocumentFrequency> DocumentFrequencyMap;
+
+//! Counts the n-grams of a range of words like countNGrams() and, in the same pass, their document frequencies.
+//!
+//! Each thread counts a contiguous slice of the words into a hash table of n-grams, packed with options.alphabet, whose
+//! entries hold both the occurrence weight and the document frequency. The n-grams of each word are deduplicated with a
+//! small open-addressing scratch set that is reset between words, so an n-gram's document frequency is updated only on its
+//! first occurrence in a word. The slices are merged in order, so the result for a given thread count is deterministic.
+//! options.engine is not used.
+//!
+//! If options.minWeight is positive, the n-grams whose weight over the range is less than it are dropped from both the
+//! counts and the document frequencies, as by countNGrams().
+//!
+//! @param counts               Counts to add to.
+//! @param documentFrequencies  Document frequencies to add to, indexed by n-gram length like counts.ngramMaps.
+//! @param words                The words and their weights.
+//! @param begin                Index of the first word to count.
+//! @param end                  Index past the last word to count.
+//! @param options              Counting options.
+void countDocumentFrequencies(NGramCounts &                       counts,
+                              std::vector<DocumentFrequencyMap> & documentFrequencies,
+                              WordList const &                    words,
+                              size_t                              begin,
+                              size_t                              end,
+                              CountingOptions const &             options);
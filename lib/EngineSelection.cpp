@@ -0,0 +1,268 @@
+#include "EngineSelection.h"
+
+#include "CountMinSketch.h"
+#include "HyperLogLog.h"
+#include "NGramEngines.h"
+#include "NGramKey.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <functional>
+#include <string>
+
+namespace
+{
+
+// Bytes of an entry of an NGramMap holding an n-gram of a given length: the node (link, std::string, weight and cached
+// hash), its allocation overhead and its bucket. Strings longer than the small-string buffer add their own allocation.
+double mapEntryBytes(size_t length)
+{
+    double bytes = 72.0;
+    if (length > 15)
+    {
+        bytes += 16.0 + static_cast<double>((length + 16) / 16 * 16);
+    }
+    return bytes;
+}
+
+// Bytes of an entry of an NGramTable, which is at most a quarter full after it grows
+double const TABLE_ENTRY_BYTES = 4.0 * sizeof(KeyedWeight);
+
+// Bytes of the kernel engine's dense arrays of lengths 1 to 3: a weight and a flag for each of 32^n n-grams
+double const KERNEL_DENSE_BYTES = (32.0 + 32.0 * 32.0 + 32.0 * 32.0 * 32.0) * (sizeof(double) + 1);
+
+// Longest length the kernel engine counts into dense arrays
+size_t const KERNEL_DENSE_LENGTH = 3;
+
+// Bytes of a candidate of the level-wise engine (a key and three positions)
+double const LEVELWISE_CANDIDATE_BYTES = 24.0;
+
+// Table sizes of one thread's slice
+struct SliceEstimate
+{
+    std::vector<HyperLogLog> distinct;
+    std::vector<double>      totalWeights;
+    size_t                   occurrences = 0;
+    size_t                   characters  = 0;
+
+    void add(size_t length, uint64_t fingerprint, double weight)
+    {
+        if (distinct.size() <= length)
+        {
+            distinct.resize(length + 1);
+            totalWeights.resize(length + 1, 0.0);
+        }
+        distinct[length].add(fingerprint);
+        totalWeights[length] += weight;
+        ++occurrences;
+    }
+};
+
+// Estimates words[begin, end) into a slice
+void estimateSlice(SliceEstimate & slice, WordList const & words, size_t begin, size_t end)
+{
+    // Packed keys and string hashes are distinct fingerprints except by rare collisions, which only lower the estimate
+    std::hash<std::string> const hash;
+    for (size_t w = begin; w < end; ++w)
+    {
+        std::string_view const word   = words[w].first;
+        double const           weight = words[w].second;
+        slice.characters += word.size();
+        if (!isPackable(word))
+        {
+            for (size_t n = 1; n <= word.size(); ++n)
+            {
+                for (size_t i = 0; i <= word.size() - n; ++i)
+                {
+                    std::string ngram = replaceSpecialSequences(word.substr(i, n));
+                    slice.add(ngram.size(), hash(ngram), weight);
+                }
+            }
+            continue;
+        }
+        forEachNormalizedNGram(word,
+                               [&](NGramKey key, size_t length, size_t start, size_t rawLength)
+                               {
+                                   uint64_t fingerprint =
+                                       (key != 0) ? key : hash(replaceSpecialSequences(word.substr(start, rawLength)));
+                                   slice.add(length, fingerprint, weight);
+                               });
+    }
+}
+
+} // anonymous namespace
+
+//! @param  words   The words and their weights.
+//! @param  begin   Index of the first word.
+//! @param  end     Index past the last word.
+//! @param  threads Number of threads to use.
+//!
+//! @return The estimate.
+NGramEstimate estimateNGrams(WordList const & words, size_t begin, size_t end, unsigned threads)
+{
+    size_t const count = (end > begin) ? end - begin : 0;
+    threads            = static_cast<unsigned>(std::min<size_t>(std::max(threads, 1u), std::max<size_t>(count, 1)));
+
+    std::vector<SliceEstimate> slices(threads);
+    runParallel(threads,
+                [&](unsigned t)
+                {
+                    estimateSlice(slices[t],
+                                  words,
+                                  begin + sliceBegin(count, t, threads),
+                                  begin + sliceBegin(count, t + 1, threads));
+                });
+
+    // Merge the slices in order
+    SliceEstimate & merged = slices[0];
+    for (unsigned t = 1; t < threads; ++t)
+    {
+        SliceEstimate const & slice = slices[t];
+        if (merged.distinct.size() < slice.distinct.size())
+        {
+            merged.distinct.resize(slice.distinct.size());
+            merged.totalWeights.resize(slice.totalWeights.size(), 0.0);
+        }
+        for (size_t length = 0; length < slice.distinct.size(); ++length)
+        {
+            merged.distinct[length].merge(slice.distinct[length]);
+            merged.totalWeights[length] += slice.totalWeights[length];
+        }
+        merged.occurrences += slice.occurrences;
+        merged.characters += slice.characters;
+    }
+
+    NGramEstimate estimate;
+    estimate.distinctNGrams.assign(merged.distinct.size(), 0.0);
+    for (size_t length = 1; length < merged.distinct.size(); ++length)
+    {
+        estimate.distinctNGrams[length] = merged.distinct[length].estimate();
+    }
+    estimate.totalWeights = std::move(merged.totalWeights);
+    estimate.occurrences  = merged.occurrences;
+    estimate.characters   = merged.characters;
+    return estimate;
+}
+
+//! @param  engine      The engine.
+//! @param  estimate    Table sizes estimated by estimateNGrams().
+//! @param  options     Counting options.
+//!
+//! @return The estimated peak memory, in bytes.
+double estimateEngineMemory(CountingEngine engine, NGramEstimate const & estimate, CountingOptions const & options)
+{
+    double const threads     = std::max(options.threads, 1u);
+    bool const   thresholded = options.minWeight > 0.0;
+
+    // Every distinct n-gram, and the n-grams that can reach the threshold, in maps and in packed-key tables
+    double allMaps       = 0.0;
+    double resultMaps    = 0.0;
+    double allTables     = 0.0; // Lengths longer than the kernel engine's dense arrays
+    double resultTables  = 0.0;
+    double largestLength = 0.0; // Most distinct n-grams of one length
+    for (size_t length = 1; length < estimate.distinctNGrams.size(); ++length)
+    {
+        double const distinct = estimate.distinctNGrams[length];
+        double const result =
+            thresholded ? std::min(distinct, estimate.totalWeights[length] / options.minWeight) : distinct;
+        allMaps += distinct * mapEntryBytes(length);
+        resultMaps += result * mapEntryBytes(length);
+        resultTables += result * TABLE_ENTRY_BYTES;
+        if (length > KERNEL_DENSE_LENGTH)
+        {
+            allTables += distinct * TABLE_ENTRY_BYTES;
+        }
+        largestLength = std::max(largestLength, distinct);
+    }
+
+    // Engines other than the sketch and level-wise engines count every n-gram and then drop the light ones
+    double const pruned      = thresholded ? resultMaps : 0.0;
+    double const sortEntries = static_cast<double>(estimate.occurrences) * sizeof(KeyedWeight);
+    switch (engine)
+    {
+    case CountingEngine::Hash:
+        // Each thread's slice, and the merged counts, unless the threads share the counts by length
+        if (options.parallelism == Parallelism::Lengths)
+        {
+            return allMaps + pruned;
+        }
+        return (threads > 1 ? threads * allMaps + allMaps : allMaps) + pruned;
+    case CountingEngine::Radix:
+        // The entries and the radix sort's buffer
+        return 2.0 * sortEntries + allMaps + pruned;
+    case CountingEngine::Kernel:
+        return threads * (KERNEL_DENSE_BYTES + allTables) + allMaps + pruned;
+    case CountingEngine::Sketch:
+    {
+        // The sketch, and each thread's table of the n-grams that pass it
+        double totalWeight = 0.0;
+        for (double weight : estimate.totalWeights)
+        {
+            totalWeight += weight;
+        }
+        size_t const width =
+            thresholded ? CountMinSketch::widthFor(totalWeight, options.minWeight, estimate.occurrences) : 1;
+        double const sketch = static_cast<double>(width * SKETCH_DEPTH) * sizeof(double);
+        return sketch + threads * (thresholded ? resultTables : allTables) + resultMaps;
+    }
+    case CountingEngine::Levelwise:
+        // The candidates of two levels, and one level's tables
+        return 2.0 * static_cast<double>(estimate.characters) * LEVELWISE_CANDIDATE_BYTES +
+               threads * largestLength * TABLE_ENTRY_BYTES + resultMaps;
+    }
+    return allMaps; // Should never reach here
+}
+
+//! @param  words       The words and their weights.
+//! @param  begin       Index of the first word to count.
+//! @param  end         Index past the last word to count.
+//! @param  options     Counting options.
+//! @param  memoryLimit Memory limit, in bytes.
+//!
+//! @return The selection.
+EngineSelection selectCountingEngine(WordList const &        words,
+                                     size_t                  begin,
+                                     size_t                  end,
+                                     CountingOptions const & options,
+                                     double                  memoryLimit)
+{
+    EngineSelection selection;
+    selection.estimate = estimateNGrams(words, begin, end, options.threads);
+
+    std::vector<CountingEngine> order;
+    if (options.minWeight > 0.0)
+    {
+        order = {CountingEngine::Levelwise,
+                 CountingEngine::Kernel,
+                 CountingEngine::Radix,
+                 CountingEngine::Sketch,
+                 CountingEngine::Hash};
+    }
+    else
+    {
+        order = {CountingEngine::Kernel, CountingEngine::Radix, CountingEngine::Hash};
+    }
+    for (CountingEngine engine : order)
+    {
+        selection.candidates.push_back({engine, estimateEngineMemory(engine, selection.estimate, options)});
+    }
+
+    auto const fits = std::find_if(selection.candidates.begin(),
+                                   selection.candidates.end(),
+                                   [memoryLimit](EngineCandidate const & candidate)
+                                   { return candidate.bytes <= memoryLimit; });
+    selection.fits = fits != selection.candidates.end();
+    if (selection.fits)
+    {
+        selection.engine = fits->engine;
+    }
+    else
+    {
+        selection.engine = std::min_element(selection.candidates.begin(),
+                                            selection.candidates.end(),
+                                            [](EngineCandidate const & a, EngineCandidate const & b)
+                                            { return a.bytes < b.bytes; })
+                               ->engine;
+    }
+    return selection;
+}
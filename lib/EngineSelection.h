@@ -0,0 +1,81 @@
+#pragma once
+
+#include "NGramCounter.h"
+#include "NGramCounts.h"
+
+#include <cstddef>
+#include <vector>
+
+//! Sizes of the n-gram tables of a range of words, estimated in one pass without counting the n-grams.
+struct NGramEstimate
+{
+    std::vector<double> distinctNGrams; //!< Estimated number of distinct n-grams (HyperLogLog), indexed by length
+    std::vector<double> totalWeights;   //!< Total weight of all n-grams, indexed by length (exact)
+    size_t              occurrences = 0; //!< Number of n-grams, counting each occurrence
+    size_t              characters  = 0; //!< Number of characters in the words
+};
+
+//! Estimates the sizes of the n-gram tables of a range of words.
+//!
+//! Every n-gram of every word is added to a HyperLogLog estimator of its length, so the pass costs about as much as
+//! enumerating the n-grams, and its memory does not depend on the number of n-grams. Each thread estimates a slice of the
+//! words, and the estimators are then merged.
+//!
+//! @param  words   The words and their weights.
+//! @param  begin   Index of the first word.
+//! @param  end     Index past the last word.
+//! @param  threads Number of threads to use.
+//!
+//! @return The estimate.
+NGramEstimate estimateNGrams(WordList const & words, size_t begin, size_t end, unsigned threads);
+
+//! Estimates the peak memory used by an engine to count a range of words, including the resulting counts.
+//!
+//! The estimate follows the engine's data structures: the node-based maps of NGramCounts, the packed-key tables (at most
+//! a quarter full after growing), the dense arrays of the kernel engine, the entry and sort buffers of the radix engine,
+//! the sketch of the sketch engine and the candidate lists of the level-wise engine. With a weight threshold, the number
+//! of n-grams of a length that reach it is bounded by the total weight of the length divided by the threshold. Thread
+//! slices are assumed to hold every distinct n-gram, so the estimate is an upper bound for more than one thread.
+//!
+//! @param  engine      The engine.
+//! @param  estimate    Table sizes estimated by estimateNGrams().
+//! @param  options     Counting options. options.engine is not used.
+//!
+//! @return The estimated peak memory, in bytes.
+double estimateEngineMemory(CountingEngine engine, NGramEstimate const & estimate, CountingOptions const & options);
+
+//! Memory estimate of an engine considered by selectCountingEngine().
+struct EngineCandidate
+{
+    CountingEngine engine; //!< The engine
+    double         bytes;  //!< Estimated peak memory, in bytes
+};
+
+//! Engine chosen by selectCountingEngine(), and why.
+struct EngineSelection
+{
+    CountingEngine               engine;     //!< The chosen engine
+    bool                         fits;       //!< True if the engine's estimate is within the memory limit
+    std::vector<EngineCandidate> candidates; //!< The engines considered, fastest first
+    NGramEstimate                estimate;   //!< Table sizes the choice was based on
+};
+
+//! Chooses the fastest counting engine whose estimated memory fits a limit.
+//!
+//! The engines are considered from the fastest: the kernel engine (dense arrays for the shortest lengths and packed-key
+//! tables for the others), the radix engine and the hash engine. With a weight threshold, the level-wise engine comes
+//! first, and the sketch engine, which only stores the n-grams that pass its sketch, before the hash engine. If no engine
+//! fits, the one with the smallest estimate is chosen.
+//!
+//! @param  words       The words and their weights.
+//! @param  begin       Index of the first word to count.
+//! @param  end         Index past the last word to count.
+//! @param  options     Counting options. options.engine is not used.
+//! @param  memoryLimit Memory limit, in bytes.
+//!
+//! @return The selection.
+EngineSelection selectCountingEngine(WordList const &        words,
+                                     size_t                  begin,
+                                     size_t                  end,
+                                     CountingOptions const & options,
+                                     double                  memoryLimit);
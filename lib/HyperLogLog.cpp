@@ -0,0 +1,101 @@
+#include "HyperLogLog.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+
+// Limits of the precision
+unsigned const MIN_PRECISION = 4;
+unsigned const MAX_PRECISION = 18;
+
+// Mixes the bits of a value (the splitmix64 finalizer)
+uint64_t mix(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+}
+
+// Returns the number of leading zero bits of a nonzero value
+unsigned countLeadingZeros(uint64_t x)
+{
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_clzll(x));
+#else
+    unsigned count = 0;
+    for (uint64_t bit = uint64_t(1) << 63; (x & bit) == 0; bit >>= 1)
+    {
+        ++count;
+    }
+    return count;
+#endif
+}
+
+} // anonymous namespace
+
+//! @param  precision   log2 of the number of registers, from 4 to 18.
+//!
+//! @throws std::invalid_argument if the precision is out of range.
+HyperLogLog::HyperLogLog(unsigned precision)
+    : precision(precision)
+{
+    if (precision < MIN_PRECISION || precision > MAX_PRECISION)
+    {
+        throw std::invalid_argument("HyperLogLog precision must be from 4 to 18.");
+    }
+    registers.assign(size_t(1) << precision, 0);
+}
+
+//! @param  fingerprint Identifies the item.
+void HyperLogLog::add(uint64_t fingerprint)
+{
+    uint64_t const hash = mix(fingerprint);
+    size_t const   i    = static_cast<size_t>(hash >> (64 - precision));
+
+    // A sentinel bit below the remaining bits limits the run of zeros
+    uint64_t const rest = (hash << precision) | (uint64_t(1) << (precision - 1));
+    registers[i]        = std::max(registers[i], static_cast<uint8_t>(countLeadingZeros(rest) + 1));
+}
+
+//! Small estimates are corrected with linear counting of the empty registers.
+//!
+//! @return The estimated number of distinct items.
+double HyperLogLog::estimate() const
+{
+    double const m     = static_cast<double>(registers.size());
+    double       sum   = 0.0;
+    size_t       zeros = 0;
+    for (uint8_t r : registers)
+    {
+        sum += std::ldexp(1.0, -static_cast<int>(r));
+        zeros += (r == 0) ? 1 : 0;
+    }
+    double const alpha  = 0.7213 / (1.0 + 1.079 / m);
+    double const result = alpha * m * m / sum;
+    if (result <= 2.5 * m && zeros > 0)
+    {
+        return m * std::log(m / static_cast<double>(zeros));
+    }
+    return result;
+}
+
+//! @param  other   An estimator with the same precision.
+//!
+//! @throws std::invalid_argument if the estimators have different precisions.
+void HyperLogLog::merge(HyperLogLog const & other)
+{
+    if (other.precision != precision)
+    {
+        throw std::invalid_argument("Cannot merge HyperLogLog estimators of different precisions.");
+    }
+    for (size_t i = 0; i < registers.size(); ++i)
+    {
+        registers[i] = std::max(registers[i], other.registers[i]);
+    }
+}
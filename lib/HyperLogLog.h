@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//! HyperLogLog estimator of the number of distinct items.
+//!
+//! Items are identified by 64-bit fingerprints, which are mixed so that similar fingerprints are spread. The top bits of a
+//! mixed fingerprint select one of 2^precision registers, which keeps the longest run of leading zeros seen in the other
+//! bits. The estimate has a relative standard error of about 1.04 / sqrt(2^precision), and the sketch takes one byte per
+//! register whatever the number of items.
+class HyperLogLog
+{
+public:
+    //! Constructs an empty estimator with 2^precision registers.
+    explicit HyperLogLog(unsigned precision = 12);
+
+    //! Adds an item.
+    void add(uint64_t fingerprint);
+
+    //! Returns the estimated number of distinct items added.
+    double estimate() const;
+
+    //! Adds the items of another estimator of the same precision to this estimator.
+    void merge(HyperLogLog const & other);
+
+private:
+    unsigned             precision; // log2 of the number of registers
+    std::vector<uint8_t> registers; // Longest run of leading zeros, plus one, seen by each register
+};
@@ -0,0 +1,277 @@
+#include "JsonWriter.h"
+
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+
+namespace
+{
+
+// Number of spaces per level of indentation
+size_t const INDENT = 2;
+
+// Decimal exponents, as the position of the decimal point relative to the first digit, outside of which nlohmann::json
+// writes doubles in scientific notation
+int const MIN_DECIMAL_POINT = -4;
+int const MAX_DECIMAL_POINT = 15;
+
+// Formats a double as nlohmann::json does. Returns the end of the text.
+char * formatDouble(char * out, double x)
+{
+    if (!std::isfinite(x))
+    {
+        return std::copy_n("null", 4, out);
+    }
+    if (std::signbit(x))
+    {
+        *out++ = '-';
+        x      = -x;
+    }
+    if (x == 0.0)
+    {
+        return std::copy_n("0.0", 3, out);
+    }
+
+    // The shortest digits, as "d.ddde+xx"
+    char         scientific[32];
+    char const * end      = std::to_chars(scientific, scientific + sizeof(scientific), x, std::chars_format::scientific).ptr;
+    char const * exponent = std::find(static_cast<char const *>(scientific), end, 'e');
+    char         digits[20];
+    int          k = 0; // Number of digits
+    for (char const * p = scientific; p != exponent; ++p)
+    {
+        if (*p != '.')
+        {
+            digits[k++] = *p;
+        }
+    }
+    char const * e10 = exponent + ((exponent[1] == '+') ? 2 : 1);
+    int          n   = 0; // Position of the decimal point
+    std::from_chars(e10, end, n);
+    ++n;
+
+    if (k <= n && n <= MAX_DECIMAL_POINT)
+    {
+        // digits000.0
+        out = std::copy_n(digits, k, out);
+        out = std::fill_n(out, n - k, '0');
+        return std::copy_n(".0", 2, out);
+    }
+    if (0 < n && n <= MAX_DECIMAL_POINT)
+    {
+        // dig.its
+        out    = std::copy_n(digits, n, out);
+        *out++ = '.';
+        return std::copy_n(digits + n, k - n, out);
+    }
+    if (MIN_DECIMAL_POINT < n && n <= 0)
+    {
+        // 0.000digits
+        out = std::copy_n("0.", 2, out);
+        out = std::fill_n(out, -n, '0');
+        return std::copy_n(digits, k, out);
+    }
+
+    // d.igitse+xx, with at least two exponent digits
+    *out++ = digits[0];
+    if (k > 1)
+    {
+        *out++ = '.';
+        out    = std::copy_n(digits + 1, k - 1, out);
+    }
+    int e  = n - 1;
+    *out++ = 'e';
+    *out++ = (e < 0) ? '-' : '+';
+    e      = std::abs(e);
+    if (e < 10)
+    {
+        *out++ = '0';
+    }
+    return std::to_chars(out, out + 4, e).ptr;
+}
+
+// Returns the length of the valid UTF-8 sequence at the start of s, or 0 if it is not valid
+size_t utf8SequenceLength(std::string_view s)
+{
+    auto const byte         = [&s](size_t i) { return static_cast<unsigned char>(s[i]); };
+    auto const continuation = [&](size_t i, unsigned char lo, unsigned char hi)
+    { return i < s.size() && byte(i) >= lo && byte(i) <= hi; };
+
+    unsigned char const lead = byte(0);
+    if (lead < 0x80)
+    {
+        return 1;
+    }
+    if (lead >= 0xc2 && lead <= 0xdf)
+    {
+        return continuation(1, 0x80, 0xbf) ? 2 : 0;
+    }
+    if (lead >= 0xe0 && lead <= 0xef)
+    {
+        // No overlong forms and no surrogates
+        unsigned char const lo = (lead == 0xe0) ? 0xa0 : 0x80;
+        unsigned char const hi = (lead == 0xed) ? 0x9f : 0xbf;
+        return (continuation(1, lo, hi) && continuation(2, 0x80, 0xbf)) ? 3 : 0;
+    }
+    if (lead >= 0xf0 && lead <= 0xf4)
+    {
+        // No overlong forms and nothing above U+10FFFF
+        unsigned char const lo = (lead == 0xf0) ? 0x90 : 0x80;
+        unsigned char const hi = (lead == 0xf4) ? 0x8f : 0xbf;
+        return (continuation(1, lo, hi) && continuation(2, 0x80, 0xbf) && continuation(3, 0x80, 0xbf)) ? 4 : 0;
+    }
+    return 0;
+}
+
+} // anonymous namespace
+
+//! @param  name    The key.
+void JsonWriter::key(std::string_view name)
+{
+    if (hasItems.back())
+    {
+        output.append(",");
+    }
+    hasItems.back() = true;
+    newLine();
+    appendString(name);
+    output.append(": ");
+    afterKey = true;
+}
+
+//! @param  s   The string.
+void JsonWriter::value(std::string_view s)
+{
+    beginValue();
+    appendString(s);
+}
+
+//! @param  x   The double.
+void JsonWriter::value(double x)
+{
+    beginValue();
+    char text[32];
+    output.append(std::string_view(text, static_cast<size_t>(formatDouble(text, x) - text)));
+}
+
+//! @param  x   The integer.
+void JsonWriter::value(uint64_t x)
+{
+    beginValue();
+    char text[24];
+    output.append(std::string_view(text, static_cast<size_t>(std::to_chars(text, text + sizeof(text), x).ptr - text)));
+}
+
+void JsonWriter::beginValue()
+{
+    if (afterKey)
+    {
+        afterKey = false;
+    }
+    else if (!hasItems.empty())
+    {
+        if (hasItems.back())
+        {
+            output.append(",");
+        }
+        hasItems.back() = true;
+        newLine();
+    }
+}
+
+//! @param  bracket The opening bracket.
+void JsonWriter::open(char bracket)
+{
+    beginValue();
+    output.append(std::string_view(&bracket, 1));
+    hasItems.push_back(false);
+}
+
+//! An empty object or array is closed on the line it was opened on.
+//!
+//! @param  bracket The closing bracket.
+void JsonWriter::close(char bracket)
+{
+    bool const empty = !hasItems.back();
+    hasItems.pop_back();
+    if (!empty)
+    {
+        newLine();
+    }
+    output.append(std::string_view(&bracket, 1));
+}
+
+void JsonWriter::newLine()
+{
+    static std::string const spaces(64, ' ');
+    output.append("\n");
+    for (size_t indent = hasItems.size() * INDENT; indent > 0;)
+    {
+        size_t const count = std::min(indent, spaces.size());
+        output.append(std::string_view(spaces).substr(0, count));
+        indent -= count;
+    }
+}
+
+//! @param  s   The string.
+void JsonWriter::appendString(std::string_view s)
+{
+    output.append("\"");
+    size_t runStart = 0; // Start of the characters that are copied as they are
+    for (size_t i = 0; i < s.size();)
+    {
+        unsigned char const c = static_cast<unsigned char>(s[i]);
+        if (c >= 0x20 && c != '"' && c != '\\' && c < 0x80)
+        {
+            ++i;
+            continue;
+        }
+        size_t const length = (c >= 0x80) ? utf8SequenceLength(s.substr(i)) : 0;
+        if (length > 0)
+        {
+            i += length;
+            continue;
+        }
+
+        output.append(s.substr(runStart, i - runStart));
+        switch (c)
+        {
+        case '"':
+            output.append("\\\"");
+            break;
+        case '\\':
+            output.append("\\\\");
+            break;
+        case '\b':
+            output.append("\\b");
+            break;
+        case '\f':
+            output.append("\\f");
+            break;
+        case '\n':
+            output.append("\\n");
+            break;
+        case '\r':
+            output.append("\\r");
+            break;
+        case '\t':
+            output.append("\\t");
+            break;
+        default:
+            if (c < 0x20)
+            {
+                char const hex[]    = "0123456789abcdef";
+                char const escape[] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf]};
+                output.append(std::string_view(escape, sizeof(escape)));
+            }
+            else
+            {
+                output.append("\xef\xbf\xbd"); // U+FFFD
+            }
+            break;
+        }
+        runStart = ++i;
+    }
+    output.append(s.substr(runStart));
+    output.append("\"");
+}
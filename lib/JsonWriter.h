@@ -0,0 +1,130 @@
+#pragma once
+
+#include "OutputBuffer.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+//! Writes JSON to a stream as it is produced, laid out as nlohmann::json::dump(2) lays it out.
+//!
+//! Objects and arrays are opened and closed explicitly, and each key and value is formatted into an OutputBuffer, so no
+//! document is built in memory. Numbers are formatted as nlohmann::json formats them: integers in decimal, and doubles
+//! with the shortest digits that read back as the same value, with ".0" after integral values and "null" for infinities
+//! and NaNs. Strings are escaped as nlohmann::json escapes them, except that an invalid UTF-8 byte is written as U+FFFD
+//! instead of failing.
+//!
+//! The writer does not check that the calls form a valid document. Keys are written in the order they are given;
+//! nlohmann::json orders them, so the caller must too to get the same output (see writeSortedObject()).
+class JsonWriter
+{
+public:
+    //! Constructs a writer that writes to a stream.
+    explicit JsonWriter(std::ostream & out, size_t bufferSize = OUTPUT_BUFFER_SIZE)
+        : output(out, bufferSize)
+    {
+    }
+
+    //! Constructs a writer that writes items of the innermost array of another writer's document to another stream, laid
+    //! out as if that writer wrote them after the specified number of items. See writeItemsOrdered().
+    JsonWriter(std::ostream & out, JsonWriter const & parent, size_t previousItems, size_t bufferSize = OUTPUT_BUFFER_SIZE)
+        : output(out, bufferSize)
+        , hasItems(parent.hasItems)
+    {
+        hasItems.back() = previousItems > 0;
+    }
+
+    //! Opens an object. The number of members is not needed in JSON.
+    void beginObject(size_t members = 0)
+    {
+        static_cast<void>(members);
+        open('{');
+    }
+
+    //! Closes the innermost object.
+    void endObject() { close('}'); }
+
+    //! Opens an array. The number of items is not needed in JSON.
+    void beginArray(size_t items = 0)
+    {
+        static_cast<void>(items);
+        open('[');
+    }
+
+    //! Closes the innermost array.
+    void endArray() { close(']'); }
+
+    //! Writes the key of the next member of the innermost object.
+    void key(std::string_view name);
+
+    //! Writes a string.
+    void value(std::string_view s);
+
+    //! Writes a double.
+    void value(double x);
+
+    //! Writes an unsigned integer.
+    void value(uint64_t x);
+
+    //! Records that items of the innermost array were written by writers continuing this one.
+    void skipItems(size_t items)
+    {
+        if (items > 0)
+        {
+            hasItems.back() = true;
+        }
+    }
+
+    //! Writes the buffered output to the stream.
+    void flush() { output.flush(); }
+
+private:
+    // Starts a value: a separator and an indented line in an array, nothing after a key
+    void beginValue();
+
+    // Opens an object or an array
+    void open(char bracket);
+
+    // Closes an object or an array
+    void close(char bracket);
+
+    // Starts a line indented for the current depth
+    void newLine();
+
+    // Appends an escaped string in quotes
+    void appendString(std::string_view s);
+
+    OutputBuffer      output;           // The buffered output
+    std::vector<bool> hasItems;         // Whether each open object or array has a member yet, innermost last
+    bool              afterKey = false; // True if a key was just written
+};
+
+//! Writes a map as an object with its keys in increasing order, as nlohmann::json orders them.
+//!
+//! Only pointers to the entries are sorted, so the map is not copied.
+//!
+//! @param writer       The writer: a JsonWriter or a BinaryWriter.
+//! @param map          A map whose keys are strings.
+//! @param writeValue   Called as writeValue(writer, value) to write each value.
+template <typename Writer, typename Map, typename WriteValue>
+void writeSortedObject(Writer & writer, Map const & map, WriteValue && writeValue)
+{
+    std::vector<typename Map::value_type const *> entries;
+    entries.reserve(map.size());
+    for (auto const & entry : map)
+    {
+        entries.push_back(&entry);
+    }
+    std::sort(entries.begin(), entries.end(), [](auto const * a, auto const * b) { return a->first < b->first; });
+
+    writer.beginObject(entries.size());
+    for (auto const * entry : entries)
+    {
+        writer.key(entry->first);
+        writeValue(writer, entry->second);
+    }
+    writer.endObject();
+}
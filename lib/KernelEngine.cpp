@@ -0,0 +1,290 @@
+// Length-specialized counting engine
+//
+// The n-grams starting at each position of a word are produced by a walk that follows the normalization of
+// replaceSpecialSequences() one token at a time, as forEachNormalizedNGram() does. Here each n-gram length from 1 to
+// KERNEL_LENGTHS has its own kernel, a template instantiated for that length, which consumes one token, counts the n-gram it
+// ends and calls the kernel of the next length. The kernels are inlined into one unrolled walk in which every length is a
+// compile-time constant, so each key has the smallest unsigned type that holds it and the counting target is chosen at
+// compile time: the shortest lengths are counted into dense arrays indexed by the packed key, and the others into a
+// packed-key hash table. The walk continues on the generic path for longer n-grams, and words with characters outside
+// the normalized alphabet are counted by NGramCounts::addWord().
+
+#include "NGramEngines.h"
+
+#include "NGramKey.h"
+#include "NGramTable.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+// Number of lengths counted by specialized kernels
+constexpr size_t KERNEL_LENGTHS = 8;
+static_assert(KERNEL_LENGTHS < MAX_PACKED_NGRAM_LENGTH, "A replaced 'y' or 'w' after the last kernel must be packable");
+
+// Lengths up to this one are counted into dense arrays, of 32^n entries for length n
+constexpr size_t MAX_DENSE_LENGTH = 3;
+
+// Smallest unsigned type that holds a packed n-gram of N symbols
+template <size_t N>
+using KernelKey = std::conditional_t<N * NGRAM_KEY_SYMBOL_BITS <= 16,
+                                     uint16_t,
+                                     std::conditional_t<N * NGRAM_KEY_SYMBOL_BITS <= 32, uint32_t, uint64_t>>;
+
+// Weights of the n-grams of one length, in a dense array indexed by the packed n-gram
+struct DenseCounts
+{
+    std::vector<double>  weights; // Weight of each n-gram
+    std::vector<uint8_t> counted; // 1 if the n-gram was counted, even with weight 0
+};
+
+// Counts of one slice of the words
+struct SliceCounts
+{
+    std::array<DenseCounts, MAX_DENSE_LENGTH + 1> dense;   // Lengths 1 to MAX_DENSE_LENGTH
+    NGramTable                                    table;   // Longer packed n-grams
+    std::vector<KeyedWeight>                      pending; // Packed n-grams waiting to be added to the table in a batch
+    NGramCounts                                   generic; // Unpacked n-grams, and the total weights of every length
+
+    SliceCounts()
+    {
+        for (size_t n = 1; n <= MAX_DENSE_LENGTH; ++n)
+        {
+            dense[n].weights.assign(size_t(1) << (NGRAM_KEY_SYMBOL_BITS * n), 0.0);
+            dense[n].counted.assign(size_t(1) << (NGRAM_KEY_SYMBOL_BITS * n), 0);
+        }
+    }
+};
+
+// Adds the weight of a packed n-gram longer than MAX_DENSE_LENGTH. The n-grams are added to the table in batches, so that
+// the table's cache misses overlap.
+void addPacked(SliceCounts & counts, NGramKey key, double weight)
+{
+    counts.pending.push_back({key, weight});
+    if (counts.pending.size() == NGramTable::ADD_BATCH_WINDOW * 4)
+    {
+        counts.table.addBatch(counts.pending.data(), counts.pending.size());
+        counts.pending.clear();
+    }
+}
+
+// Adds the weight of an n-gram of length N, packed in the smallest key that holds it
+template <size_t N>
+void addNGram(SliceCounts & counts, KernelKey<N> key, double weight)
+{
+    if constexpr (N <= MAX_DENSE_LENGTH)
+    {
+        counts.dense[N].weights[key] += weight;
+        counts.dense[N].counted[key] = 1;
+    }
+    else
+    {
+        addPacked(counts, key, weight);
+    }
+    counts.generic.totalWeights[N] += weight;
+}
+
+// Counts the n-grams longer than KERNEL_LENGTHS that start at a position, continuing a walk that has consumed the
+// characters before p into the n-gram key of the specified length. Equivalent to the inner loop of
+// forEachNormalizedNGram().
+void countLongNGrams(std::string_view word,
+                     double           weight,
+                     size_t           start,
+                     size_t           p,
+                     NGramKey         key,
+                     size_t           length,
+                     SliceCounts &    counts)
+{
+    using namespace NGramKeyDetail;
+
+    auto visit = [&](size_t rawEnd)
+    {
+        if (length <= MAX_PACKED_NGRAM_LENGTH)
+        {
+            addPacked(counts, key, weight);
+            counts.generic.totalWeights[length] += weight;
+        }
+        else
+        {
+            counts.generic.addNGram(replaceSpecialSequences(word.substr(start, rawEnd - start)), weight);
+        }
+    };
+    auto push = [&](char c)
+    {
+        ++length;
+        key = (length <= MAX_PACKED_NGRAM_LENGTH) ? (key << NGRAM_KEY_SYMBOL_BITS) | symbolCode(c) : 0;
+    };
+
+    while (p < word.size())
+    {
+        char const c0 = word[p];
+        char const c1 = (p + 1 < word.size()) ? word[p + 1] : '\0';
+
+        NGramKey const prefixKey    = key;
+        size_t const   prefixLength = length;
+        push(c0);
+        visit(p + 1);
+        if ((c1 == 'y' && precedesVowelY(c0)) || (c1 == 'w' && precedesVowelW(c0)))
+        {
+            push(c1 == 'y' ? 'Y' : 'W');
+            visit(p + 2);
+            p += 2;
+        }
+        else if (c0 == 'q' && c1 == 'u')
+        {
+            key    = prefixKey;
+            length = prefixLength;
+            push('Q');
+            visit(p + 2);
+            p += 2;
+        }
+        else
+        {
+            p += 1;
+        }
+    }
+}
+
+// Kernel of length N: consumes the token at p of the walk starting at start, whose n-gram so far is key (N - 1 symbols),
+// counts the n-grams of length N (and N + 1 for a replaced 'y' or 'w') that it ends, and continues with the kernel of the
+// next length. The kernels of every length are inlined into one unrolled walk.
+template <size_t N>
+void countFrom(std::string_view word, double weight, size_t start, size_t p, KernelKey<N - 1> key, SliceCounts & counts)
+{
+    using namespace NGramKeyDetail;
+    using Key = KernelKey<N>;
+
+    constexpr unsigned BITS = NGRAM_KEY_SYMBOL_BITS;
+
+    if constexpr (N > KERNEL_LENGTHS)
+    {
+        countLongNGrams(word, weight, start, p, key, N - 1, counts);
+    }
+    else
+    {
+        if (p >= word.size())
+        {
+            return;
+        }
+        char const c0 = word[p];
+        char const c1 = (p + 1 < word.size()) ? word[p + 1] : '\0';
+
+        Key const extended = static_cast<Key>((Key(key) << BITS) | symbolCode(c0));
+        addNGram<N>(counts, extended, weight);
+        if ((c1 == 'y' && precedesVowelY(c0)) || (c1 == 'w' && precedesVowelW(c0)))
+        {
+            using LongerKey = KernelKey<N + 1>;
+            LongerKey const withReplaced =
+                static_cast<LongerKey>((LongerKey(extended) << BITS) | symbolCode(c1 == 'y' ? 'Y' : 'W'));
+            if constexpr (N + 1 <= KERNEL_LENGTHS)
+            {
+                addNGram<N + 1>(counts, withReplaced, weight);
+                countFrom<N + 2>(word, weight, start, p + 2, withReplaced, counts);
+            }
+            else
+            {
+                addPacked(counts, withReplaced, weight);
+                counts.generic.totalWeights[N + 1] += weight;
+                countLongNGrams(word, weight, start, p + 2, withReplaced, N + 1, counts);
+            }
+        }
+        else if (c0 == 'q' && c1 == 'u')
+        {
+            Key const replaced = static_cast<Key>((Key(key) << BITS) | symbolCode('Q'));
+            addNGram<N>(counts, replaced, weight);
+            countFrom<N + 1>(word, weight, start, p + 2, replaced, counts);
+        }
+        else
+        {
+            countFrom<N + 1>(word, weight, start, p + 1, extended, counts);
+        }
+    }
+}
+
+// Counts words[begin, end) into a slice
+void countSlice(SliceCounts & counts, WordList const & words, size_t begin, size_t end)
+{
+    for (size_t w = begin; w < end; ++w)
+    {
+        auto const & [word, weight] = words[w];
+        if (!isPackable(word))
+        {
+            counts.generic.addWord(word, weight);
+            continue;
+        }
+
+        counts.generic.extend(word.size());
+        for (size_t start = 0; start < word.size(); ++start)
+        {
+            countFrom<1>(word, weight, start, start, 0, counts);
+        }
+    }
+    counts.table.addBatch(counts.pending.data(), counts.pending.size());
+    counts.pending.clear();
+}
+
+} // anonymous namespace
+
+//! @param  counts  Counts to add to.
+//! @param  words   The words and their weights.
+//! @param  begin   Index of the first word to count.
+//! @param  end     Index past the last word to count.
+//! @param  threads Number of threads to use.
+void countWithKernelEngine(NGramCounts & counts, WordList const & words, size_t begin, size_t end, unsigned threads)
+{
+    size_t const count = end - begin;
+    if (count == 0)
+    {
+        return;
+    }
+
+    std::vector<SliceCounts> slices(threads);
+    runParallel(threads,
+                [&](unsigned t)
+                {
+                    countSlice(slices[t],
+                               words,
+                               begin + sliceBegin(count, t, threads),
+                               begin + sliceBegin(count, t + 1, threads));
+                });
+
+    // Merge the slices in order
+    SliceCounts & merged = slices[0];
+    for (unsigned t = 1; t < threads; ++t)
+    {
+        for (size_t n = 1; n <= MAX_DENSE_LENGTH; ++n)
+        {
+            for (size_t key = 0; key < merged.dense[n].weights.size(); ++key)
+            {
+                merged.dense[n].weights[key] += slices[t].dense[n].weights[key];
+                merged.dense[n].counted[key] |= slices[t].dense[n].counted[key];
+            }
+        }
+        merged.table.merge(slices[t].table);
+        merged.generic.merge(slices[t].generic);
+    }
+
+    // The generic counts hold the total weights of every length, so merging them first extends the counts to every length,
+    // and the packed n-grams are then unpacked directly into the counts
+    counts.merge(merged.generic);
+    for (size_t n = 1; n <= MAX_DENSE_LENGTH && n < counts.ngramMaps.size(); ++n)
+    {
+        for (size_t key = 0; key < merged.dense[n].weights.size(); ++key)
+        {
+            if (merged.dense[n].counted[key])
+            {
+                counts.ngramMaps[n][unpackNGram(key)] += merged.dense[n].weights[key];
+            }
+        }
+    }
+    merged.table.addTo(counts);
+}
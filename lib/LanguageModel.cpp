@@ -0,0 +1,403 @@
+#include "LanguageModel.h"
+
+#include "BinaryIO.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+// Identifies the binary form of a LanguageModel
+uint32_t const MODEL_MAGIC   = 0x4d4c474e; // "NGLM"
+uint32_t const MODEL_VERSION = 1;
+
+// Number of symbols in the normalized alphabet
+double const ALPHABET_SIZE = static_cast<double>(VOWELS.size() + CONSONANTS.size());
+
+// Returns a mask of the last length symbols of a key
+NGramKey lastSymbolsMask(size_t length)
+{
+    return (length == 0) ? 0 : (NGramKey(1) << (NGRAM_KEY_SYMBOL_BITS * length)) - 1;
+}
+
+// Returns the packed n-grams of a table and their weights, sorted by key
+std::vector<KeyedWeight> packedWeights(NGramMap const & map)
+{
+    std::vector<KeyedWeight> entries;
+    entries.reserve(map.size());
+    for (auto const & [ngram, weight] : map)
+    {
+        NGramKey key = packNGram(ngram);
+        if (key != 0 && weight > 0.0)
+        {
+            entries.push_back({key, weight});
+        }
+    }
+    std::sort(entries.begin(), entries.end(), [](auto const & a, auto const & b) { return a.key < b.key; });
+    return entries;
+}
+
+// Returns the Kneser-Ney continuation count of each n-gram of a length, the number of distinct symbols that precede it in
+// the table of the n-grams one symbol longer, sorted by key
+std::vector<KeyedWeight> continuationCounts(NGramMap const & longer, size_t length)
+{
+    std::vector<NGramKey> suffixes;
+    suffixes.reserve(longer.size());
+    for (auto const & [ngram, weight] : longer)
+    {
+        NGramKey key = packNGram(ngram);
+        if (key != 0 && weight > 0.0)
+        {
+            suffixes.push_back(key & lastSymbolsMask(length));
+        }
+    }
+    std::sort(suffixes.begin(), suffixes.end());
+
+    // The longer n-grams are distinct, so each occurrence of a suffix has a distinct preceding symbol
+    std::vector<KeyedWeight> entries;
+    for (NGramKey suffix : suffixes)
+    {
+        if (entries.empty() || entries.back().key != suffix)
+        {
+            entries.push_back({suffix, 0.0});
+        }
+        entries.back().weight += 1.0;
+    }
+    return entries;
+}
+
+// Returns the absolute discount of an order, D = u * n1 / (n1 + 2 * n2), where the counts are measured in units u of the
+// smallest count, and n1 and n2 are the numbers of n-grams counted about once and about twice. The discount is at most the
+// smallest count, so no count is discounted below 0.
+double discountFor(std::vector<KeyedWeight> const & entries)
+{
+    double unit = std::numeric_limits<double>::infinity();
+    for (auto const & entry : entries)
+    {
+        unit = std::min(unit, entry.weight);
+    }
+
+    size_t once  = 0;
+    size_t twice = 0;
+    for (auto const & entry : entries)
+    {
+        once += (entry.weight < 1.5 * unit) ? 1 : 0;
+        twice += (entry.weight >= 1.5 * unit && entry.weight < 2.5 * unit) ? 1 : 0;
+    }
+    return (once > 0) ? unit * static_cast<double>(once) / static_cast<double>(once + 2 * twice) : 0.5 * unit;
+}
+
+// Calls visit(c) for each character of the word normalized by replaceSpecialSequences(), in order, until visit returns false.
+// Returns false if visit returned false.
+template <typename Visitor>
+bool forEachNormalizedSymbol(std::string_view word, Visitor && visit)
+{
+    using namespace NGramKeyDetail;
+
+    for (size_t p = 0; p < word.size();)
+    {
+        char const c0 = word[p];
+        char const c1 = (p + 1 < word.size()) ? word[p + 1] : '\0';
+        if ((c1 == 'y' && precedesVowelY(c0)) || (c1 == 'w' && precedesVowelW(c0)))
+        {
+            if (!visit(c0) || !visit(c1 == 'y' ? 'Y' : 'W'))
+            {
+                return false;
+            }
+            p += 2;
+        }
+        else if (c0 == 'q' && c1 == 'u')
+        {
+            if (!visit('Q'))
+            {
+                return false;
+            }
+            p += 2;
+        }
+        else
+        {
+            if (!visit(c0))
+            {
+                return false;
+            }
+            p += 1;
+        }
+    }
+    return true;
+}
+
+// Writes a table sorted by key, so that equal models are written identically
+void writeTable(std::ostream & out, NGramTable const & table)
+{
+    std::vector<KeyedWeight> entries;
+    entries.reserve(table.size());
+    table.forEach([&entries](NGramKey key, double weight) { entries.push_back({key, weight}); });
+    std::sort(entries.begin(), entries.end(), [](auto const & a, auto const & b) { return a.key < b.key; });
+
+    writeBinary<uint64_t>(out, entries.size());
+    for (auto const & entry : entries)
+    {
+        writeBinary(out, entry.key);
+        writeBinary(out, entry.weight);
+    }
+}
+
+// Reads a table written by writeTable()
+NGramTable readTable(std::istream & in)
+{
+    uint64_t   count = readBinary<uint64_t>(in);
+    NGramTable table(count);
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        NGramKey key   = readBinary<NGramKey>(in);
+        double   value = readBinary<double>(in);
+        if (key == 0)
+        {
+            throw std::runtime_error("Invalid n-gram in language model.");
+        }
+        table.add(key, value);
+    }
+    return table;
+}
+
+} // anonymous namespace
+
+LanguageModel::LanguageModel()
+    : modelOrder(1)
+    , unigramBackoff(1.0)
+{
+}
+
+//! For each order k from 1 to N, the counts c of the k-grams are grouped by context h (the first k - 1 symbols). With C(h)
+//! the sum of the counts in the context, T(h) the number of distinct symbols following it, and D the discount of the order,
+//!
+//!     P(w | h) = max(c(hw) - D, 0) / C(h) + g(h) * P(w | h'),     g(h) = D * T(h) / C(h)
+//!
+//! where h' is h without its first symbol, and the probability below order 1 is uniform. P(w | h) is stored for each counted
+//! hw and g(h) for each context. An uncounted hw then has probability g(h) * P(w | h'), and a context that was not seen
+//! backs off with weight 1.
+//!
+//! @param  counts  The n-gram counts.
+//! @param  order   Order of the model.
+//!
+//! @return The model. Its order is less than the requested order if there are no counts of the longer lengths.
+//!
+//! @throws std::invalid_argument if the order is out of range.
+LanguageModel LanguageModel::build(NGramCounts const & counts, size_t order)
+{
+    if (order < 1 || order > MAX_PACKED_NGRAM_LENGTH)
+    {
+        throw std::invalid_argument("Language model order must be from 1 to " + std::to_string(MAX_PACKED_NGRAM_LENGTH) +
+                                    ".");
+    }
+
+    LanguageModel model;
+    size_t const  available = counts.ngramMaps.empty() ? 0 : counts.ngramMaps.size() - 1;
+    size_t const  highest   = std::min(order, available);
+    model.modelOrder        = std::max<size_t>(highest, 1);
+
+    // Build the orders from the lowest up, because each order interpolates with the one below it
+    for (size_t k = 1; k <= highest; ++k)
+    {
+        std::vector<KeyedWeight> const entries = (k == highest) ? packedWeights(counts.ngramMaps[k])
+                                                                : continuationCounts(counts.ngramMaps[k + 1], k);
+        double const discount = discountFor(entries);
+
+        // Sorting by key puts the n-grams with the same context next to each other
+        for (size_t begin = 0, end = 0; begin < entries.size(); begin = end)
+        {
+            NGramKey const context = entries[begin].key >> NGRAM_KEY_SYMBOL_BITS;
+            double         total   = 0.0;
+            for (end = begin; end < entries.size() && (entries[end].key >> NGRAM_KEY_SYMBOL_BITS) == context; ++end)
+            {
+                total += entries[end].weight;
+            }
+
+            double const backoff = discount * static_cast<double>(end - begin) / total;
+            for (size_t i = begin; i < end; ++i)
+            {
+                unsigned const code  = static_cast<unsigned>(entries[i].key & lastSymbolsMask(1));
+                double const   lower = (k == 1) ? 1.0 / ALPHABET_SIZE
+                                                : model.probability(context & lastSymbolsMask(k - 2), k - 2, code);
+                model.probabilities.add(entries[i].key, std::max(entries[i].weight - discount, 0.0) / total + backoff * lower);
+            }
+            if (k == 1)
+            {
+                model.unigramBackoff = backoff;
+            }
+            else
+            {
+                model.backoffs.add(context, backoff);
+            }
+        }
+    }
+    return model;
+}
+
+//! @param  context The preceding symbols.
+//! @param  length  Number of symbols in the context.
+//! @param  code    Symbol code of the symbol.
+//!
+//! @return The probability.
+double LanguageModel::probability(NGramKey context, size_t length, unsigned code) const
+{
+    // Shorten the context until the n-gram was counted, collecting the back-off weights of the longer contexts
+    double weight = 1.0;
+    for (size_t m = std::min(length, modelOrder - 1);; --m)
+    {
+        NGramKey const shortened = context & lastSymbolsMask(m);
+        if (double const * p = probabilities.find((shortened << NGRAM_KEY_SYMBOL_BITS) | code))
+        {
+            return weight * *p;
+        }
+        if (m == 0)
+        {
+            return weight * unigramBackoff / ALPHABET_SIZE;
+        }
+        if (double const * b = backoffs.find(shortened))
+        {
+            weight *= *b;
+        }
+    }
+}
+
+//! @param  word    The word.
+//!
+//! @return The log2 probability.
+double LanguageModel::logProbability(std::string_view word) const
+{
+    NGramKey context = 0;
+    size_t   length  = 0;
+    double   result  = 0.0;
+    bool     valid   = forEachNormalizedSymbol(word,
+                                         [&](char c)
+                                         {
+                                             unsigned code = symbolCode(c);
+                                             if (code == 0)
+                                             {
+                                                 return false;
+                                             }
+                                             result += std::log2(probability(context, length, code));
+
+                                             // Keep only the symbols that the next prediction uses
+                                             length  = std::min(length + 1, modelOrder - 1);
+                                             context = ((context << NGRAM_KEY_SYMBOL_BITS) | code) & lastSymbolsMask(length);
+                                             return true;
+                                         });
+    return valid ? result : -std::numeric_limits<double>::infinity();
+}
+
+//! The words are divided into contiguous slices, one per thread.
+//!
+//! @param  words   The words to score.
+//! @param  count   Number of words.
+//! @param  scores  Receives the log2 probability of each word.
+//! @param  threads Number of threads to use.
+void LanguageModel::scoreBatch(std::string_view const * words, size_t count, double * scores, unsigned threads) const
+{
+    threads = std::max(1u, std::min<unsigned>(threads, static_cast<unsigned>(std::max<size_t>(count / 1024, 1))));
+    runParallel(threads,
+                [&](unsigned t)
+                {
+                    for (size_t i = sliceBegin(count, t, threads); i < sliceBegin(count, t + 1, threads); ++i)
+                    {
+                        scores[i] = logProbability(words[i]);
+                    }
+                });
+}
+
+//! @param  words   The words to score.
+//! @param  threads Number of threads to use.
+//!
+//! @return The log2 probability of each word.
+std::vector<double> LanguageModel::scoreBatch(std::vector<std::string_view> const & words, unsigned threads) const
+{
+    std::vector<double> scores(words.size());
+    scoreBatch(words.data(), words.size(), scores.data(), threads);
+    return scores;
+}
+
+//! @param  out     The binary stream to write to.
+void LanguageModel::write(std::ostream & out) const
+{
+    writeBinary(out, MODEL_MAGIC);
+    writeBinary(out, MODEL_VERSION);
+    writeBinary<uint64_t>(out, modelOrder);
+    writeBinary(out, unigramBackoff);
+    writeTable(out, probabilities);
+    writeTable(out, backoffs);
+}
+
+//! @param  in  The binary stream to read from.
+//!
+//! @return The model.
+//!
+//! @throws std::runtime_error if the data is not a language model or is truncated.
+LanguageModel LanguageModel::read(std::istream & in)
+{
+    if (readBinary<uint32_t>(in) != MODEL_MAGIC || readBinary<uint32_t>(in) != MODEL_VERSION)
+    {
+        throw std::runtime_error("Not a language model, or an unsupported version.");
+    }
+
+    LanguageModel model;
+    model.modelOrder = readBinary<uint64_t>(in);
+    if (model.modelOrder < 1 || model.modelOrder > MAX_PACKED_NGRAM_LENGTH)
+    {
+        throw std::runtime_error("Invalid language model order.");
+    }
+    model.unigramBackoff = readBinary<double>(in);
+    model.probabilities  = readTable(in);
+    model.backoffs       = readTable(in);
+    return model;
+}
+
+//! @param  path    Path of the model file.
+//!
+//! @throws std::runtime_error if the model cannot be written.
+void LanguageModel::save(std::string const & path) const
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open())
+    {
+        throw std::runtime_error("Cannot create language model file: " + path);
+    }
+    write(out);
+    out.flush();
+    if (!out)
+    {
+        throw std::runtime_error("Failed to write language model file: " + path);
+    }
+}
+
+//! @param  path    Path of the model file.
+//!
+//! @return The model.
+//!
+//! @throws std::runtime_error if the file cannot be opened or is not a valid model.
+LanguageModel LanguageModel::load(std::string const & path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open())
+    {
+        throw std::runtime_error("Cannot open language model file: " + path);
+    }
+    try
+    {
+        return read(in);
+    }
+    catch (std::exception const & e)
+    {
+        throw std::runtime_error("Invalid language model file " + path + ": " + e.what());
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "NGramCounts.h"
+#include "NGramKey.h"
+#include "NGramTable.h"
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//! Interpolated Kneser-Ney character language model over the normalized alphabet.
+//!
+//! The model of order N predicts each symbol of a normalized word from the N - 1 symbols before it (fewer at the start of
+//! the word). It is built from n-gram counts: the highest order uses the weights of the N-grams, and each lower order k uses
+//! Kneser-Ney continuation counts, the number of distinct symbols that precede each k-gram in the (k+1)-grams. Each order
+//! subtracts an absolute discount from its counts and gives the freed probability to the next lower order, down to a
+//! uniform distribution over the alphabet.
+//!
+//! The interpolated probability of every counted n-gram and the back-off weight of every context are precomputed into flat
+//! tables keyed by packed n-grams, so the probability of a symbol is one lookup if the n-gram was counted, and otherwise a
+//! few lookups as the context is shortened.
+class LanguageModel
+{
+public:
+    //! Constructs a model of order 1 that assigns the same probability to every symbol.
+    LanguageModel();
+
+    //! Builds a model from n-gram counts.
+    //!
+    //! @param counts   The n-gram counts. The counts of lengths 1 to order + 1 are used (fewer if they are not available).
+    //!                 N-grams that cannot be packed are ignored.
+    //! @param order    Order of the model, from 1 to MAX_PACKED_NGRAM_LENGTH.
+    static LanguageModel build(NGramCounts const & counts, size_t order);
+
+    //! Returns the order of the model.
+    size_t order() const { return modelOrder; }
+
+    //! Returns the probability of a symbol following a context.
+    //!
+    //! @param context  The packed symbols preceding the symbol. Only the last order() - 1 of them are used.
+    //! @param length   Number of symbols in the context.
+    //! @param code     Symbol code of the symbol (see symbolCode()), from 1 to the size of the alphabet.
+    double probability(NGramKey context, size_t length, unsigned code) const;
+
+    //! Returns the log2 probability of a word, the sum of the log2 probabilities of its symbols.
+    //!
+    //! The word is normalized as by replaceSpecialSequences(), but symbol by symbol without building the normalized string.
+    //! Returns -infinity if the normalized word contains a character that is not in the normalized alphabet.
+    double logProbability(std::string_view word) const;
+
+    //! Computes the log2 probability of each word of a batch, as logProbability() does, dividing the words among threads.
+    //!
+    //! @param words    The words to score.
+    //! @param count    Number of words.
+    //! @param scores   Receives the log2 probability of each word.
+    //! @param threads  Number of threads to use.
+    void scoreBatch(std::string_view const * words, size_t count, double * scores, unsigned threads = 1) const;
+
+    //! Returns the log2 probability of each word of a batch. See scoreBatch() above.
+    std::vector<double> scoreBatch(std::vector<std::string_view> const & words, unsigned threads = 1) const;
+
+    //! Writes the model in binary form.
+    void write(std::ostream & out) const;
+
+    //! Reads a model written by write().
+    static LanguageModel read(std::istream & in);
+
+    //! Saves the model to a file.
+    void save(std::string const & path) const;
+
+    //! Loads a model saved by save().
+    static LanguageModel load(std::string const & path);
+
+private:
+    size_t     modelOrder;     // Order of the model
+    double     unigramBackoff; // Weight of the uniform distribution in the unigram probabilities
+    NGramTable probabilities;  // Interpolated probability of each counted n-gram, keyed by the n-gram
+    NGramTable backoffs;       // Back-off weight of each context, keyed by the context
+};
@@ -0,0 +1,287 @@
+// Level-wise (Apriori-style) thresholded counting engine
+//
+// The weight of an n-gram is never more than the weight of its prefix, the n-gram without its last symbol, because every
+// occurrence of the n-gram extends an occurrence of the prefix that starts at the same position. So when only the n-grams
+// whose weight reaches a threshold are wanted, the n-grams are counted one length at a time, and only the occurrences whose
+// prefix reached the threshold are extended to the next length. The occurrences are kept as a list of candidates between
+// levels. Long n-grams, almost all of which are light, are then barely enumerated. Without a threshold, every occurrence is
+// extended and every n-gram is counted.
+//
+// An occurrence is extended by following the normalization of replaceSpecialSequences() one token at a time, as
+// forEachNormalizedNGram() does: a character, then 'Y' or 'W' when it is followed by a 'y' or 'w' that is replaced, or 'Q'
+// in place of a 'q' followed by 'u'. N-grams are identified by their keys, packed with the alphabet of the counting
+// options, or by their normalized strings when they cannot be packed. An n-gram that can be packed is identified by its key
+// even in a word that cannot be packed, so that its weight is not split between the two tables.
+
+#include "NGramEngines.h"
+
+#include "Alphabet.h"
+#include "NGramKey.h"
+#include "NGramTable.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+
+// An occurrence of an n-gram in a word that can be extended to the next length
+struct Candidate
+{
+    NGramKey key;         // The packed n-gram, or 0 if the n-gram is not packed
+    uint32_t word;        // Index of the word, relative to the beginning of the range
+    uint32_t start;       // Position of the n-gram's first character in the word
+    uint32_t next;        // Position of the next character to consume
+    bool     pairPending; // The character before next is followed by a 'y' or 'w' that is replaced
+};
+
+// Counts and candidates produced by one thread at one level
+struct LevelCounts
+{
+    NGramTable             packed;     // Weights of the packed n-grams
+    NGramMap               unpacked;   // Weights of the other n-grams
+    std::vector<Candidate> candidates; // Occurrences that may be extended to the next level
+};
+
+// Calls emit(child, rawEnd, extendable) for each n-gram one symbol longer than a candidate, at the same position. rawEnd is
+// the position past the child's last character, and extendable is false if the child has no longer n-grams. The keys of
+// the children are packed with an alphabet, and only computed if pack is true.
+template <typename Emit>
+void forEachChild(std::string_view word, Candidate const & candidate, Alphabet const & alphabet, bool pack, Emit && emit)
+{
+    using namespace NGramKeyDetail;
+
+    auto extend = [&](char symbol) { return pack ? (candidate.key << alphabet.symbolBits()) | alphabet.code(symbol) : 0; };
+
+    Candidate child = candidate;
+    size_t    p     = candidate.next;
+    if (candidate.pairPending)
+    {
+        // The 'y' or 'w' after the last character
+        child.key         = extend(word[p + 1] == 'y' ? 'Y' : 'W');
+        child.next        = static_cast<uint32_t>(p + 2);
+        child.pairPending = false;
+        emit(child, p + 2, true);
+        return;
+    }
+    if (p >= word.size())
+    {
+        return;
+    }
+
+    char const c0 = word[p];
+    char const c1 = (p + 1 < word.size()) ? word[p + 1] : '\0';
+    if ((c1 == 'y' && precedesVowelY(c0)) || (c1 == 'w' && precedesVowelW(c0)))
+    {
+        child.key         = extend(c0);
+        child.pairPending = true;
+        emit(child, p + 1, true);
+    }
+    else if (c0 == 'q' && c1 == 'u')
+    {
+        // An n-gram ending with this 'q' is never extended, because the 'u' replaces it with 'Q'
+        child.key = extend('q');
+        emit(child, p + 1, false);
+
+        child.key  = extend('Q');
+        child.next = static_cast<uint32_t>(p + 2);
+        emit(child, p + 2, true);
+    }
+    else
+    {
+        child.key  = extend(c0);
+        child.next = static_cast<uint32_t>(p + 1);
+        emit(child, p + 1, true);
+    }
+}
+
+// Returns the normalized n-gram of a child that ends before rawEnd
+std::string normalizedChild(std::string_view word, Candidate const & child, size_t rawEnd)
+{
+    return replaceSpecialSequences(word.substr(child.start, rawEnd - child.start));
+}
+
+// Adds the weight of a word to the total weight of the length of each of its n-grams. Each n-gram has at most one child
+// that can be extended, so the n-grams starting at each position form a chain.
+void addTotalWeights(std::string_view word, double weight, std::vector<double> & totalWeights)
+{
+    for (size_t start = 0; start < word.size(); ++start)
+    {
+        auto const position = static_cast<uint32_t>(start);
+        Candidate  node{0, 0, position, position, false};
+        bool       extended = true;
+        for (size_t length = 1; extended; ++length)
+        {
+            extended = false;
+            forEachChild(word,
+                         node,
+                         Alphabet::english(),
+                         false,
+                         [&](Candidate const & child, size_t, bool extendable)
+                         {
+                             totalWeights[length] += weight;
+                             if (extendable)
+                             {
+                                 node     = child;
+                                 extended = true;
+                             }
+                         });
+        }
+    }
+}
+
+} // anonymous namespace
+
+//! @param  counts      Counts to add to.
+//! @param  words       The words and their weights.
+//! @param  begin       Index of the first word to count.
+//! @param  end         Index past the last word to count.
+//! @param  threads     Number of threads to use.
+//! @param  minWeight   N-grams with less weight are not counted. 0 counts every n-gram.
+//! @param  alphabet    Symbols the n-grams are packed with.
+void countWithLevelwiseEngine(NGramCounts &    counts,
+                              WordList const & words,
+                              size_t           begin,
+                              size_t           end,
+                              unsigned         threads,
+                              double           minWeight,
+                              Alphabet const & alphabet)
+{
+    size_t const count = end - begin;
+    if (count == 0)
+    {
+        return;
+    }
+
+    size_t maxWordLength = 0;
+    for (size_t w = begin; w < end; ++w)
+    {
+        maxWordLength = std::max(maxWordLength, words[w].first.size());
+    }
+    NGramCounts result;
+    result.extend(maxWordLength);
+
+    // The total weights include the n-grams that are never enumerated, so they are computed from the lengths alone. Level 0
+    // holds an empty n-gram at every position of every word.
+    std::vector<bool>      packable(count);
+    std::vector<Candidate> candidates;
+    for (size_t w = 0; w < count; ++w)
+    {
+        auto const & [word, weight] = words[begin + w];
+        packable[w]                 = alphabet.isPackable(word);
+        addTotalWeights(word, weight, result.totalWeights);
+        for (size_t i = 0; i < word.size(); ++i)
+        {
+            auto const position = static_cast<uint32_t>(i);
+            candidates.push_back({0, static_cast<uint32_t>(w), position, position, false});
+        }
+    }
+
+    std::vector<LevelCounts> levels(threads);
+    for (size_t length = 1; !candidates.empty(); ++length)
+    {
+        bool const pack  = length <= alphabet.maxPackedLength();
+        size_t     total = candidates.size();
+
+        // Count the children of the candidates, each thread a slice of them
+        runParallel(threads,
+                    [&](unsigned t)
+                    {
+                        LevelCounts & level = levels[t];
+                        level.packed        = NGramTable();
+                        level.unpacked.clear();
+                        level.candidates.clear();
+                        for (size_t i = sliceBegin(total, t, threads); i < sliceBegin(total, t + 1, threads); ++i)
+                        {
+                            Candidate const & candidate = candidates[i];
+                            auto const & [word, weight] = words[begin + candidate.word];
+                            bool const packed           = pack && packable[candidate.word];
+                            forEachChild(word,
+                                         candidate,
+                                         alphabet,
+                                         packed,
+                                         [&](Candidate const & child, size_t rawEnd, bool extendable)
+                                         {
+                                             if (packed)
+                                             {
+                                                 level.packed.add(child.key, weight);
+                                             }
+                                             else
+                                             {
+                                                 std::string ngram = normalizedChild(word, child, rawEnd);
+                                                 NGramKey const key = alphabet.pack(ngram);
+                                                 if (key != 0)
+                                                 {
+                                                     level.packed.add(key, weight);
+                                                 }
+                                                 else
+                                                 {
+                                                     level.unpacked[std::move(ngram)] += weight;
+                                                 }
+                                             }
+                                             if (extendable)
+                                             {
+                                                 level.candidates.push_back(child);
+                                             }
+                                         });
+                        }
+                    });
+
+        // Merge the threads' weights in order
+        for (unsigned t = 1; t < threads; ++t)
+        {
+            levels[0].packed.merge(levels[t].packed);
+            for (auto const & [ngram, weight] : levels[t].unpacked)
+            {
+                levels[0].unpacked[ngram] += weight;
+            }
+        }
+        LevelCounts const & merged = levels[0];
+        merged.packed.forEach(
+            [&](NGramKey key, double weight)
+            {
+                if (reachesMinWeight(weight, minWeight))
+                {
+                    result.ngramMaps[length].emplace(alphabet.unpack(key), weight);
+                }
+            });
+        for (auto const & [ngram, weight] : merged.unpacked)
+        {
+            if (reachesMinWeight(weight, minWeight))
+            {
+                result.ngramMaps[length].emplace(ngram, weight);
+            }
+        }
+
+        // Keep the children whose n-gram reached the threshold, in order
+        auto const isLight = [&](Candidate const & child)
+        {
+            if (pack && packable[child.word])
+            {
+                return !reachesMinWeight(merged.packed.weight(child.key), minWeight);
+            }
+            size_t const      rawEnd = child.pairPending ? child.next + 1 : child.next;
+            std::string const ngram  = normalizedChild(words[begin + child.word].first, child, rawEnd);
+            NGramKey const    key    = alphabet.pack(ngram);
+            double const      weight = (key != 0) ? merged.packed.weight(key) : merged.unpacked.find(ngram)->second;
+            return !reachesMinWeight(weight, minWeight);
+        };
+        runParallel(threads,
+                    [&](unsigned t)
+                    {
+                        auto & next = levels[t].candidates;
+                        next.erase(std::remove_if(next.begin(), next.end(), isLight), next.end());
+                    });
+        candidates.clear();
+        for (unsigned t = 0; t < threads; ++t)
+        {
+            candidates.insert(candidates.end(), levels[t].candidates.begin(), levels[t].candidates.end());
+        }
+    }
+
+    counts.merge(result);
+}
@@ -0,0 +1,243 @@
+#include "NGramCounter.h"
+
+#include "Alphabet.h"
+#include "NGramEngines.h"
+#include "Parallel.h"
+#include "WordArena.h"
+#include "WordSchedule.h"
+
+#include <algorithm>
+#include <vector>
+
+std::vector<CountingEngine> const & countingEngines()
+{
+    static std::vector<CountingEngine> const engines = {CountingEngine::Hash,
+                                                               CountingEngine::Radix,
+                                                               CountingEngine::Sketch,
+                                                               CountingEngine::Levelwise,
+                                                               CountingEngine::Kernel};
+    return engines;
+}
+
+//! @param  engine  The engine.
+//!
+//! @return The name of the engine.
+std::string_view countingEngineName(CountingEngine engine)
+{
+    switch (engine)
+    {
+    case CountingEngine::Hash:
+        return "hash";
+    case CountingEngine::Radix:
+        return "radix";
+    case CountingEngine::Sketch:
+        return "sketch";
+    case CountingEngine::Levelwise:
+        return "levelwise";
+    case CountingEngine::Kernel:
+        return "kernel";
+    }
+    return "unknown"; // Should never reach here
+}
+
+//! @param  counts  Counts to add to.
+//! @param  words   The words and their weights.
+//! @param  begin   Index of the first word to count.
+//! @param  end     Index past the last word to count.
+//! @param  options Counting options.
+void countNGrams(NGramCounts & counts, WordList const & words, size_t begin, size_t end, CountingOptions const & options)
+{
+    size_t           count    = (end > begin) ? end - begin : 0;
+    unsigned         threads  = static_cast<unsigned>(std::min<size_t>(std::max(options.threads, 1u), std::max<size_t>(count, 1)));
+    Alphabet const & alphabet = options.alphabet ? *options.alphabet : Alphabet::english();
+
+    // The sketch and level-wise engines apply the threshold themselves
+    if (options.engine == CountingEngine::Sketch)
+    {
+        countWithSketchEngine(counts, words, begin, begin + count, threads, options.minWeight, alphabet);
+        return;
+    }
+    if (options.engine == CountingEngine::Levelwise)
+    {
+        countWithLevelwiseEngine(counts, words, begin, begin + count, threads, options.minWeight, alphabet);
+        return;
+    }
+
+    // Other engines count every n-gram of the range, so the range must be counted separately before it is thresholded
+    if (options.minWeight > 0.0)
+    {
+        CountingOptions unthresholded = options;
+        unthresholded.minWeight       = 0.0;
+        NGramCounts rangeCounts;
+        countNGrams(rangeCounts, words, begin, begin + count, unthresholded);
+        rangeCounts.prune(options.minWeight);
+        counts.merge(rangeCounts);
+        return;
+    }
+
+    // The radix and kernel engines parallelize internally
+    if (options.engine == CountingEngine::Radix)
+    {
+        countWithRadixEngine(counts, words, begin, begin + count, threads, alphabet);
+        return;
+    }
+    if (options.engine == CountingEngine::Kernel)
+    {
+        countWithKernelEngine(counts, words, begin, begin + count, threads);
+        return;
+    }
+
+    if (options.parallelism == Parallelism::Lengths)
+    {
+        countWithHashEngineByLength(counts, words, begin, begin + count, threads);
+        return;
+    }
+    if (threads == 1)
+    {
+        countWithHashEngine(counts, words, begin, begin + count);
+        return;
+    }
+
+    // Count each slice into its own table, then merge the tables in order
+    std::vector<NGramCounts> sliceCounts(threads);
+    runParallel(threads,
+                [&](unsigned t)
+                {
+                    countWithHashEngine(sliceCounts[t],
+                                        words,
+                                        begin + sliceBegin(count, t, threads),
+                                        begin + sliceBegin(count, t + 1, threads));
+                });
+    for (auto const & slice : sliceCounts)
+    {
+        counts.merge(slice);
+    }
+}
+
+//! The words are counted in the order of a WordSchedule, each block one substring length at a time, so that the tables of
+//! one length are updated for a whole block of words in a row.
+//!
+//! @param  counts  Counts to add to.
+//! @param  words   The words and their weights.
+//! @param  begin   Index of the first word to count.
+//! @param  end     Index past the last word to count.
+void countWithHashEngine(NGramCounts & counts, WordList const & words, size_t begin, size_t end)
+{
+    WordSchedule const schedule = scheduleWords(words, begin, end);
+    for (auto const & block : schedule.blocks)
+    {
+        // A "qu" makes a word longer than its normalized length
+        size_t maxLength = 0;
+        for (size_t i = block.begin; i < block.end; ++i)
+        {
+            maxLength = std::max(maxLength, words[schedule.order[i]].first.size());
+        }
+        counts.extend(maxLength);
+
+        for (size_t n = 1; n <= maxLength; ++n)
+        {
+            for (size_t i = block.begin; i < block.end; ++i)
+            {
+                auto const & [word, weight] = words[schedule.order[i]];
+                if (word.size() >= n)
+                {
+                    counts.addSubstrings(word, weight, n);
+                }
+            }
+        }
+    }
+}
+
+//! The lengths 1 to the longest word's length are divided into contiguous ranges, one per thread, holding about as many
+//! substrings each. Every thread scans all the words, in order, and counts the substrings whose normalized length is in its
+//! range directly into the counts. A replaced "qu" makes a substring one character longer than its normalized length, so a
+//! thread also counts the substrings that are longer than its range by at most the number of "qu" in the word.
+//!
+//! @param  counts  Counts to add to.
+//! @param  words   The words and their weights.
+//! @param  begin   Index of the first word to count.
+//! @param  end     Index past the last word to count.
+//! @param  threads Number of threads to use.
+void countWithHashEngineByLength(NGramCounts & counts, WordList const & words, size_t begin, size_t end, unsigned threads)
+{
+    // The words, which every thread scans, and the number of words of each length
+    WordArena           arena;
+    std::vector<size_t> wordsOfLength(1, 0);
+    for (size_t w = begin; w < end; ++w)
+    {
+        size_t const length = words[w].first.size();
+        arena.add(words[w].first);
+        if (wordsOfLength.size() <= length)
+        {
+            wordsOfLength.resize(length + 1, 0);
+        }
+        ++wordsOfLength[length];
+    }
+    size_t const maxLength = wordsOfLength.size() - 1;
+    if (maxLength == 0)
+    {
+        return;
+    }
+    counts.extend(maxLength);
+
+    // Divide the lengths into ranges of about as many substrings
+    std::vector<double> substrings(maxLength + 1, 0.0);
+    double              total = 0.0;
+    for (size_t n = 1; n <= maxLength; ++n)
+    {
+        for (size_t length = n; length <= maxLength; ++length)
+        {
+            substrings[n] += static_cast<double>(wordsOfLength[length] * (length - n + 1));
+        }
+        total += substrings[n];
+    }
+    threads = static_cast<unsigned>(std::min<size_t>(threads, maxLength));
+    std::vector<size_t> firstLength(threads + 1, maxLength + 1);
+    firstLength[0]  = 1;
+    double   sum    = 0.0;
+    unsigned ranges = 1;
+    for (size_t n = 1; n <= maxLength && ranges < threads; ++n)
+    {
+        sum += substrings[n];
+        if (sum >= total * ranges / threads)
+        {
+            firstLength[ranges++] = n + 1;
+        }
+    }
+
+    runParallel(threads,
+                [&](unsigned t)
+                {
+                    size_t const        lo = firstLength[t];
+                    size_t const        hi = firstLength[t + 1] - 1;
+                    std::vector<double> totals(hi + 1, 0.0);
+                    for (size_t w = 0; w < arena.size(); ++w)
+                    {
+                        std::string_view const word   = arena[w];
+                        double const           weight = words[begin + w].second;
+                        size_t                 qus    = 0;
+                        for (size_t p = word.find("qu"); p != std::string_view::npos; p = word.find("qu", p + 2))
+                        {
+                            ++qus;
+                        }
+                        size_t const longest = std::min(word.size(), hi + qus);
+                        for (size_t n = lo; n <= longest; ++n)
+                        {
+                            for (size_t i = 0; i <= word.size() - n; ++i)
+                            {
+                                std::string  ngram     = replaceSpecialSequences(word.substr(i, n));
+                                size_t const ngramSize = ngram.size();
+                                if (ngramSize >= lo && ngramSize <= hi)
+                                {
+                                    counts.ngramMaps[ngramSize][std::move(ngram)] += weight;
+                                    totals[ngramSize] += weight;
+                                }
+                            }
+                        }
+                    }
+                    for (size_t n = lo; n <= hi; ++n)
+                    {
+                        counts.totalWeights[n] += totals[n];
+                    }
+                });
+}
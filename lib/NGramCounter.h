@@ -0,0 +1,64 @@
+#pragma once
+
+#include "NGramCounts.h"
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+class Alphabet;
+
+//! Algorithms for counting n-grams. All engines produce the same counts (up to floating-point rounding).
+enum class CountingEngine
+{
+    Hash, //!< Normalizes each substring and adds it to a hash map (NGramCounts::addWord)
+    Radix, //!< Sorts every packed n-gram with a radix sort and sums equal keys (no hashing)
+    Sketch, //!< Counts only the n-grams that pass a Count-Min sketch prefilter of the weight threshold
+    Levelwise, //!< Counts one length at a time, extending only the n-grams whose prefix reached the weight threshold
+    Kernel //!< Counts each short length with a kernel specialized for it, the shortest into dense arrays
+};
+
+//! How the hash engine divides the counting among threads.
+enum class Parallelism
+{
+    Words,  //!< Each thread counts a slice of the words into its own tables, which are then merged
+    Lengths //!< Each thread counts the n-grams of its own lengths, of every word, directly into the counts
+};
+
+//! Options controlling how n-grams are counted.
+struct CountingOptions
+{
+    CountingEngine   engine      = CountingEngine::Hash; //!< Counting algorithm
+    unsigned         threads     = 1;                    //!< Number of threads counting in parallel
+    double           minWeight   = 0.0;                  //!< N-grams with less weight are dropped (0 keeps every n-gram)
+    Alphabet const * alphabet    = nullptr;              //!< Symbols the engines pack with (nullptr: English)
+    Parallelism      parallelism = Parallelism::Words;   //!< How the hash engine divides the counting among threads
+};
+
+//! Returns all counting engines.
+std::vector<CountingEngine> const & countingEngines();
+
+//! Returns the name of a counting engine, as used on the command line.
+std::string_view countingEngineName(CountingEngine engine);
+
+//! Counts the n-grams of a range of words.
+//!
+//! For the hash engine, the words are partitioned into contiguous slices, one per thread. Each slice is counted separately,
+//! in the deterministic order of a WordSchedule, and the results are merged in slice order, so the result for a given thread
+//! count is deterministic. With Parallelism::Lengths, the n-gram lengths are instead divided into contiguous ranges with
+//! about as many substrings each, one per thread. Every thread scans all the words and adds only the n-grams of its own
+//! lengths, in word order, to the counts: there are no per-thread tables, no merge and no shared writes, and the result does
+//! not depend on the thread count. The radix engine expands and sorts the n-grams of all the words in parallel, and its
+//! result does not depend on the thread count. The kernel engine partitions the words like the hash engine.
+//!
+//! If options.minWeight is positive, the n-grams whose weight over the range is less than it are dropped, but still count
+//! towards the total weights. The threshold applies to each call, so a range that is counted in several calls is not
+//! thresholded correctly. The sketch engine avoids storing most of the dropped n-grams, and the level-wise engine avoids
+//! enumerating most of them; the other engines count every n-gram and then drop the light ones.
+//!
+//! @param counts   Counts to add to.
+//! @param words    The words and their weights.
+//! @param begin    Index of the first word to count.
+//! @param end      Index past the last word to count.
+//! @param options  Counting options.
+void countNGrams(NGramCounts & counts, WordList const & words, size_t begin, size_t end, CountingOptions const & options);
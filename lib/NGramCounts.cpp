@@ -0,0 +1,242 @@
+#include "NGramCounts.h"
+
+#include "Alphabet.h"
+#include "BinaryIO.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+// Identifies the binary frozen form of NGramCounts
+uint32_t const FROZEN_MAGIC   = 0x4d52474e; // "NGRM"
+uint32_t const FROZEN_VERSION = 1;
+
+} // anonymous namespace
+
+//! @param  input   The string to normalize.
+//!
+//! @return The normalized string.
+std::string replaceSpecialSequences(std::string_view input)
+{
+    std::string result;
+    result.reserve(input.size()); // Reserve enough space
+
+    size_t i = 0;
+    while (i < input.size())
+    {
+        char c0 = input[i++];
+
+        // It's the next character that determines what to do, so always push the current character
+        result.push_back(c0);
+
+        // The replaced sequences are all two characters long, so only check if there's a next character
+        if (i < input.size())
+        {
+            char c1 = input[i];
+            // Replace 'y' preceded by certain vowels or any consonant with 'Y'
+            if (c1 == 'y')
+            {
+                if (c0 == 'a' || c0 == 'e' || c0 == 'o' || c0 == 'u' || CONSONANTS.find(c0) != std::string_view::npos)
+                {
+                    result.push_back('Y');
+                    ++i; // Eat two characters
+                }
+            }
+            // Replace 'w' preceded by certain vowels with 'W'
+            else if (c1 == 'w')
+            {
+                if (c0 == 'a' || c0 == 'e' || c0 == 'o')
+                {
+                    result.push_back('W');
+                    ++i; // Eat two characters
+                }
+            }
+
+            // Replace "qu" with 'Q'
+            if (c0 == 'q')
+            {
+                if (c1 == 'u')
+                {
+                    result.back() = 'Q'; // Replace 'q' that was already pushed with 'Q'. Forget the 'u'.
+                    ++i;                 // Eat two characters
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+//! Every substring of the word is normalized and counted under its normalized length.
+//!
+//! @param  word    The word to count.
+//! @param  weight  The weight of the word. The weight of an n-gram is the frequency of the word containing it.
+void NGramCounts::addWord(std::string_view word, double weight)
+{
+    // Extend the data if necessary to accommodate a word of this length.
+    size_t wordLength = word.length();
+    extend(wordLength);
+
+    // For each possible n-gram in the word, accumulate its count/frequency/weight.
+    for (size_t n = 1; n <= wordLength; ++n)
+    {
+        addSubstrings(word, weight, n);
+    }
+}
+
+//! @param  word    The word to count.
+//! @param  weight  The weight of the word.
+//! @param  length  Length of the substrings.
+void NGramCounts::addSubstrings(std::string_view word, double weight, size_t length)
+{
+    for (size_t i = 0; i <= word.length() - length; ++i)
+    {
+        // Special handling for certain sequences
+        std::string ngram = replaceSpecialSequences(word.substr(i, length));
+
+        // Count the n-gram
+        size_t ngramSize = ngram.size();
+        ngramMaps[ngramSize][std::move(ngram)] += weight;
+        totalWeights[ngramSize] += weight;
+    }
+}
+
+//! The tables are indexed by length, so there is one more table than the length of the word.
+//!
+//! @param  wordLength  Length of the word.
+void NGramCounts::extend(size_t wordLength)
+{
+    if (ngramMaps.size() < wordLength + 1)
+    {
+        ngramMaps.resize(wordLength + 1);
+        totalWeights.resize(wordLength + 1, 0);
+    }
+}
+
+//! @param  ngram   The normalized n-gram.
+//! @param  weight  The weight to add.
+void NGramCounts::addNGram(std::string_view ngram, double weight)
+{
+    extend(ngram.size());
+    ngramMaps[ngram.size()][std::string(ngram)] += weight;
+    totalWeights[ngram.size()] += weight;
+}
+
+//! @param  other   The counts to add.
+void NGramCounts::merge(NGramCounts const & other)
+{
+    if (!other.ngramMaps.empty())
+    {
+        extend(other.ngramMaps.size() - 1);
+    }
+    for (size_t n = 0; n < other.ngramMaps.size(); ++n)
+    {
+        for (auto const & [ngram, weight] : other.ngramMaps[n])
+        {
+            ngramMaps[n][ngram] += weight;
+        }
+        totalWeights[n] += other.totalWeights[n];
+    }
+}
+
+//! @param  minWeight   Smallest weight of the n-grams that are kept.
+void NGramCounts::prune(double minWeight)
+{
+    if (minWeight <= 0.0)
+    {
+        return;
+    }
+    for (auto & map : ngramMaps)
+    {
+        for (auto it = map.begin(); it != map.end();)
+        {
+            it = !reachesMinWeight(it->second, minWeight) ? map.erase(it) : std::next(it);
+        }
+    }
+}
+
+//! The frozen form is a header followed by one table per length. Each table is its total weight, its entry count, and its
+//! entries sorted by n-gram. Each entry is the n-gram (whose length is implied by the table) followed by its weight.
+//!
+//! @param  out     The binary stream to write to.
+void NGramCounts::write(std::ostream & out) const
+{
+    writeBinary(out, FROZEN_MAGIC);
+    writeBinary(out, FROZEN_VERSION);
+    writeBinary<uint32_t>(out, static_cast<uint32_t>(ngramMaps.size()));
+    for (size_t n = 0; n < ngramMaps.size(); ++n)
+    {
+        std::vector<std::pair<std::string_view, double>> entries(ngramMaps[n].begin(), ngramMaps[n].end());
+        std::sort(entries.begin(), entries.end());
+
+        writeBinary(out, totalWeights[n]);
+        writeBinary<uint64_t>(out, entries.size());
+        for (auto const & [ngram, weight] : entries)
+        {
+            out.write(ngram.data(), static_cast<std::streamsize>(ngram.size()));
+            writeBinary(out, weight);
+        }
+    }
+}
+
+//! @param  in  The binary stream to read from.
+//!
+//! @return The counts.
+//!
+//! @throws std::runtime_error if the data is not in the frozen form or is truncated.
+NGramCounts NGramCounts::read(std::istream & in)
+{
+    if (readBinary<uint32_t>(in) != FROZEN_MAGIC || readBinary<uint32_t>(in) != FROZEN_VERSION)
+    {
+        throw std::runtime_error("Not a frozen n-gram table, or an unsupported version.");
+    }
+
+    // The counts come from files that may be corrupt, so each count is checked against the bytes left before it is used
+    // to allocate. Each table takes at least its total weight and entry count, and each entry its n-gram and weight.
+    NGramCounts counts;
+    uint32_t    lengths = readBinary<uint32_t>(in);
+    if (lengths > remainingBytes(in) / (sizeof(double) + sizeof(uint64_t)))
+    {
+        throw std::runtime_error("Unexpected end of binary data.");
+    }
+    counts.ngramMaps.resize(lengths);
+    counts.totalWeights.resize(lengths, 0);
+    for (size_t n = 0; n < lengths; ++n)
+    {
+        counts.totalWeights[n] = readBinary<double>(in);
+        uint64_t entries       = readBinary<uint64_t>(in);
+        if (entries > remainingBytes(in) / (n + sizeof(double)))
+        {
+            throw std::runtime_error("Unexpected end of binary data.");
+        }
+        auto & map = counts.ngramMaps[n];
+        map.reserve(entries);
+        std::string ngram(n, '\0');
+        for (uint64_t e = 0; e < entries; ++e)
+        {
+            if (!in.read(ngram.data(), static_cast<std::streamsize>(n)))
+            {
+                throw std::runtime_error("Unexpected end of binary data.");
+            }
+            map.emplace(ngram, readBinary<double>(in));
+        }
+    }
+    return counts;
+}
+
+//! @param  counts  The counts to extract from.
+//!
+//! @return The vowel-only and consonant-only n-grams.
+VowelConsonantNGrams extractVowelConsonantNGrams(NGramCounts const & counts)
+{
+    return extractVowelConsonantNGrams(counts, Alphabet::english());
+}
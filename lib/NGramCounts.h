@@ -0,0 +1,98 @@
+#pragma once
+
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+//! Map of (n-gram, weight) pairs.
+typedef std::unordered_map<std::string, double> NGramMap;
+//! List of (word, weight) pairs.
+typedef std::vector<std::pair<std::string, double>> WordList;
+
+//! Vowels in order of frequency in English, 'Y' and 'W' represent 'y' and 'w' as vowels
+inline constexpr std::string_view VOWELS = "eoaiuYW";
+//! Consonants in order of frequency in English, 'Q' represents 'qu'
+inline constexpr std::string_view CONSONANTS = "tnhsrldymwgcfbpkvjxzqQ";
+
+//! Relative tolerance of the minimum weight comparison of reachesMinWeight().
+inline constexpr double MIN_WEIGHT_TOLERANCE = 1e-9;
+
+//! Returns true if a weight reaches a minimum weight.
+//!
+//! Engines and threads sum the weights of an n-gram in different orders, so sums that are equal in exact arithmetic can
+//! differ by rounding errors. A weight less than minWeight by at most MIN_WEIGHT_TOLERANCE times minWeight still reaches it,
+//! so an n-gram whose weight is exactly the minimum weight is kept by every engine at every thread count. Every engine and
+//! NGramCounts::prune() keep the n-grams for which this function returns true.
+inline bool reachesMinWeight(double weight, double minWeight)
+{
+    return weight >= minWeight * (1.0 - MIN_WEIGHT_TOLERANCE);
+}
+
+//! Replaces certain character sequences with special characters for analysis.
+//!
+//! "qu" is replaced with 'Q', 'y' preceded by 'a', 'e', 'o', 'u' or a consonant is replaced with 'Y', and 'w' preceded by
+//! 'a', 'e' or 'o' is replaced with 'W'.
+std::string replaceSpecialSequences(std::string_view input);
+
+//! Weighted n-gram counts, indexed by n-gram length.
+//!
+//! The weight of an n-gram is the sum of the weights of the words containing it, counted once per occurrence. N-grams are
+//! normalized with replaceSpecialSequences() before they are counted, so they are indexed by their normalized length.
+//!
+//! The counts can be written to and read from a stream in a binary "frozen" form, in which each length's table is stored as
+//! an array of entries sorted by n-gram.
+struct NGramCounts
+{
+    std::vector<NGramMap> ngramMaps;    //!< Weight of each n-gram, indexed by n-gram length
+    std::vector<double>   totalWeights; //!< Total weight of all n-grams, indexed by n-gram length
+
+    //! Counts every n-gram of a word.
+    //!
+    //! @param word     The word to count.
+    //! @param weight   The weight of the word.
+    void addWord(std::string_view word, double weight);
+
+    //! Counts the n-grams of a word that are normalized from its substrings of one length.
+    //!
+    //! Calling this for every length from 1 to the length of the word counts the same n-grams as addWord(). The tables must
+    //! have been extended for the word (see extend()).
+    //!
+    //! @param word     The word to count.
+    //! @param weight   The weight of the word.
+    //! @param length   Length of the substrings, from 1 to the length of the word.
+    void addSubstrings(std::string_view word, double weight, size_t length);
+
+    //! Extends the tables if necessary to accommodate the n-grams of a word of the specified length.
+    void extend(size_t wordLength);
+
+    //! Adds a weight to a normalized n-gram.
+    void addNGram(std::string_view ngram, double weight);
+
+    //! Removes the n-grams whose weight does not reach minWeight (see reachesMinWeight()). The total weights are unchanged.
+    void prune(double minWeight);
+
+    //! Adds the counts of another set of counts to these counts.
+    void merge(NGramCounts const & other);
+
+    //! Writes the counts in binary frozen form.
+    void write(std::ostream & out) const;
+
+    //! Reads counts written by write().
+    static NGramCounts read(std::istream & in);
+};
+
+//! N-grams consisting only of vowels or only of consonants, of all lengths.
+struct VowelConsonantNGrams
+{
+    NGramMap vowels;                //!< Weight of each vowel-only n-gram
+    NGramMap consonants;            //!< Weight of each consonant-only n-gram
+    double   totalVowels     = 0.0; //!< Total weight of the vowel-only n-grams
+    double   totalConsonants = 0.0; //!< Total weight of the consonant-only n-grams
+};
+
+//! Extracts the vowel-only and consonant-only n-grams from a set of counts, with the classes of the normalized English
+//! alphabet. See also the overload taking an Alphabet.
+VowelConsonantNGrams extractVowelConsonantNGrams(NGramCounts const & counts);
@@ -0,0 +1,52 @@
+#pragma once
+
+// Entry points of the counting engines, used by countNGrams(). Not part of the library's public interface.
+
+#include "NGramCounts.h"
+
+#include <cstddef>
+
+class Alphabet;
+
+//! Number of rows in the sketch engine's Count-Min sketch.
+inline constexpr size_t SKETCH_DEPTH = 4;
+
+//! Counts words[begin, end) with the hash engine on the calling thread, in the order of a WordSchedule.
+void countWithHashEngine(NGramCounts & counts, WordList const & words, size_t begin, size_t end);
+
+//! Counts words[begin, end) with the hash engine, using the specified number of threads, each counting its own n-gram
+//! lengths of every word.
+void countWithHashEngineByLength(NGramCounts & counts, WordList const & words, size_t begin, size_t end, unsigned threads);
+
+//! Counts words[begin, end) with the radix engine, using the specified number of threads and packing the n-grams with an
+//! alphabet.
+void countWithRadixEngine(NGramCounts &    counts,
+                          WordList const & words,
+                          size_t           begin,
+                          size_t           end,
+                          unsigned         threads,
+                          Alphabet const & alphabet);
+
+//! Counts words[begin, end) with the kernel engine, using the specified number of threads. The n-grams are packed with
+//! the normalized English alphabet whatever the alphabet of the counting options.
+void countWithKernelEngine(NGramCounts & counts, WordList const & words, size_t begin, size_t end, unsigned threads);
+
+//! Counts words[begin, end) with the sketch engine, using the specified number of threads and packing the n-grams with an
+//! alphabet. Only the n-grams whose weight is at least minWeight are counted.
+void countWithSketchEngine(NGramCounts &    counts,
+                           WordList const & words,
+                           size_t           begin,
+                           size_t           end,
+                           unsigned         threads,
+                           double           minWeight,
+                           Alphabet const & alphabet);
+
+//! Counts words[begin, end) with the level-wise engine, using the specified number of threads and packing the n-grams with
+//! an alphabet. Only the n-grams whose weight is at least minWeight are counted.
+void countWithLevelwiseEngine(NGramCounts &    counts,
+                              WordList const & words,
+                              size_t           begin,
+                              size_t           end,
+                              unsigned         threads,
+                              double           minWeight,
+                              Alphabet const & alphabet);
@@ -0,0 +1,313 @@
+#include "NGramIndex.h"
+
+#include "Parallel.h"
+#include "RadixSort.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define NGRAM_INDEX_USE_SSE2 1
+#endif
+
+namespace
+{
+
+// Appends a value as a varint
+void appendVarint(std::vector<uint8_t> & out, uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+// Adds the distinct n-grams of a word, packed with an alphabet, to a list of keys
+void addWordKeys(std::vector<NGramKey> & wordKeys, std::string_view word, Alphabet const & alphabet)
+{
+    if (alphabet.isPackable(word))
+    {
+        alphabet.forEachNormalizedNGram(word,
+                                        [&wordKeys](NGramKey key, size_t, size_t, size_t)
+                                        {
+                                            if (key != 0)
+                                            {
+                                                wordKeys.push_back(key);
+                                            }
+                                        });
+    }
+    else
+    {
+        for (size_t n = 1; n <= std::min(word.size(), alphabet.maxPackedLength()); ++n)
+        {
+            for (size_t i = 0; i <= word.size() - n; ++i)
+            {
+                NGramKey const key = alphabet.pack(replaceSpecialSequences(word.substr(i, n)));
+                if (key != 0)
+                {
+                    wordKeys.push_back(key);
+                }
+            }
+        }
+    }
+    std::sort(wordKeys.begin(), wordKeys.end());
+    wordKeys.erase(std::unique(wordKeys.begin(), wordKeys.end()), wordKeys.end());
+}
+
+// Returns every id from 0 to count - 1
+std::vector<uint32_t> allIds(size_t count)
+{
+    std::vector<uint32_t> ids(count);
+    std::iota(ids.begin(), ids.end(), 0u);
+    return ids;
+}
+
+} // anonymous namespace
+
+//! @param  words       The words and their weights.
+//! @param  threads     Number of threads to use.
+//! @param  alphabet    Symbols the n-grams are packed with.
+//!
+//! @return The index.
+//!
+//! @throws std::invalid_argument if there are too many words to number with 32-bit ids.
+NGramIndex NGramIndex::build(WordList const & words, unsigned threads, Alphabet const & alphabet)
+{
+    if (words.size() > std::numeric_limits<uint32_t>::max())
+    {
+        throw std::invalid_argument("Too many words to index.");
+    }
+
+    // Number the words by decreasing weight
+    std::vector<size_t> order(words.size());
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::stable_sort(order.begin(),
+                     order.end(),
+                     [&words](size_t a, size_t b) { return words[b].second < words[a].second; });
+
+    NGramIndex index;
+    index.alphabet = alphabet;
+    index.weights.reserve(words.size());
+    for (size_t w : order)
+    {
+        index.arena.add(words[w].first);
+        index.weights.push_back(words[w].second);
+    }
+
+    // List the distinct n-grams of each word with its id, which a double holds exactly, in id order
+    threads = static_cast<unsigned>(std::min<size_t>(std::max(threads, 1u), std::max<size_t>(words.size(), 1)));
+    std::vector<std::vector<KeyedWeight>> slices(threads);
+    runParallel(threads,
+                [&](unsigned t)
+                {
+                    std::vector<NGramKey> wordKeys;
+                    for (size_t id = sliceBegin(words.size(), t, threads); id < sliceBegin(words.size(), t + 1, threads);
+                         ++id)
+                    {
+                        wordKeys.clear();
+                        addWordKeys(wordKeys, index.arena[id], alphabet);
+                        for (NGramKey key : wordKeys)
+                        {
+                            slices[t].push_back({key, static_cast<double>(id)});
+                        }
+                    }
+                });
+    std::vector<KeyedWeight> entries = std::move(slices[0]);
+    for (unsigned t = 1; t < threads; ++t)
+    {
+        entries.insert(entries.end(), slices[t].begin(), slices[t].end());
+    }
+
+    // The sort is stable, so the ids of each n-gram stay in increasing order
+    radixSort(entries, threads);
+
+    uint32_t previous = 0;
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        uint32_t const id = static_cast<uint32_t>(entries[i].weight);
+        if (i == 0 || entries[i].key != entries[i - 1].key)
+        {
+            index.keys.push_back(entries[i].key);
+            index.offsets.push_back(index.postingData.size());
+            appendVarint(index.postingData, id);
+        }
+        else
+        {
+            appendVarint(index.postingData, id - previous);
+        }
+        previous = id;
+    }
+    index.offsets.push_back(index.postingData.size());
+    return index;
+}
+
+//! @param  ngram   The normalized n-gram.
+//!
+//! @return The ids of the words containing the n-gram.
+std::vector<uint32_t> NGramIndex::postings(std::string_view ngram) const
+{
+    NGramKey const key = alphabet.pack(ngram);
+    auto const     it  = std::lower_bound(keys.begin(), keys.end(), key);
+    if (key == 0 || it == keys.end() || *it != key)
+    {
+        return {};
+    }
+    return decode(static_cast<size_t>(it - keys.begin()));
+}
+
+//! @param  ngrams  The normalized n-grams. If there are none, every word matches.
+//!
+//! @return The ids of the words containing every n-gram.
+std::vector<uint32_t> NGramIndex::wordsWithAll(std::vector<std::string> const & ngrams) const
+{
+    if (ngrams.empty())
+    {
+        return allIds(size());
+    }
+
+    std::vector<std::vector<uint32_t>> lists;
+    lists.reserve(ngrams.size());
+    for (auto const & ngram : ngrams)
+    {
+        lists.push_back(postings(ngram));
+        if (lists.back().empty())
+        {
+            return {};
+        }
+    }
+    std::sort(lists.begin(),
+              lists.end(),
+              [](std::vector<uint32_t> const & a, std::vector<uint32_t> const & b) { return a.size() < b.size(); });
+
+    std::vector<uint32_t> result = std::move(lists[0]);
+    for (size_t i = 1; i < lists.size() && !result.empty(); ++i)
+    {
+        result = intersectPostings(result, lists[i]);
+    }
+    return result;
+}
+
+//! The substring is split into runs of symbols of the index's alphabet, and each run into pieces of at most
+//! Alphabet::maxPackedLength() characters. A word containing the substring contains every piece, so it contains the
+//! normalized n-gram of every piece.
+//!
+//! @param  substring   The substring.
+//!
+//! @return The ids of the words containing the substring.
+std::vector<uint32_t> NGramIndex::wordsContaining(std::string_view substring) const
+{
+    std::vector<std::string> ngrams;
+    size_t                   p = 0;
+    while (p < substring.size())
+    {
+        if (alphabet.code(substring[p]) == 0)
+        {
+            ++p;
+            continue;
+        }
+        size_t runEnd = p;
+        while (runEnd < substring.size() && alphabet.code(substring[runEnd]) != 0)
+        {
+            ++runEnd;
+        }
+
+        // The last piece of a run ends at its end, and may overlap the one before it
+        size_t const pieceLength = std::min(runEnd - p, alphabet.maxPackedLength());
+        for (size_t start = p; start < runEnd; start += pieceLength)
+        {
+            std::string ngram = replaceSpecialSequences(substring.substr(std::min(start, runEnd - pieceLength), pieceLength));
+            if (alphabet.pack(ngram) != 0)
+            {
+                ngrams.push_back(std::move(ngram));
+            }
+        }
+        p = runEnd;
+    }
+
+    std::vector<uint32_t> candidates = ngrams.empty() ? allIds(size()) : wordsWithAll(ngrams);
+    candidates.erase(std::remove_if(candidates.begin(),
+                                    candidates.end(),
+                                    [&](uint32_t id) { return word(id).find(substring) == std::string_view::npos; }),
+                     candidates.end());
+    return candidates;
+}
+
+//! @param  index   Index of the n-gram in keys.
+//!
+//! @return The ids of the posting list.
+std::vector<uint32_t> NGramIndex::decode(size_t index) const
+{
+    std::vector<uint32_t> ids;
+    uint32_t              id = 0;
+    for (size_t p = offsets[index]; p < offsets[index + 1];)
+    {
+        uint32_t delta = 0;
+        for (unsigned shift = 0;; shift += 7)
+        {
+            uint8_t const byte = postingData[p++];
+            delta |= static_cast<uint32_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0)
+            {
+                break;
+            }
+        }
+        id += delta;
+        ids.push_back(id);
+    }
+    return ids;
+}
+
+//! @param  a   A list of ids in increasing order.
+//! @param  b   Another list of ids in increasing order.
+//!
+//! @return The ids in both lists.
+std::vector<uint32_t> intersectPostings(std::vector<uint32_t> const & a, std::vector<uint32_t> const & b)
+{
+    std::vector<uint32_t> const & small = (a.size() <= b.size()) ? a : b;
+    std::vector<uint32_t> const & large = (a.size() <= b.size()) ? b : a;
+
+    std::vector<uint32_t> result;
+    size_t                j = 0;
+    for (uint32_t id : small)
+    {
+        // Skip the blocks of four ids that are all smaller
+        while (j + 4 <= large.size() && large[j + 3] < id)
+        {
+            j += 4;
+        }
+        if (j + 4 <= large.size())
+        {
+#if defined(NGRAM_INDEX_USE_SSE2)
+            __m128i const block = _mm_loadu_si128(reinterpret_cast<__m128i const *>(large.data() + j));
+            __m128i const equal = _mm_cmpeq_epi32(block, _mm_set1_epi32(static_cast<int>(id)));
+            if (_mm_movemask_epi8(equal) != 0)
+#else
+            if (large[j] == id || large[j + 1] == id || large[j + 2] == id || large[j + 3] == id)
+#endif
+            {
+                result.push_back(id);
+            }
+            continue;
+        }
+
+        // Fewer than four ids are left
+        while (j < large.size() && large[j] < id)
+        {
+            ++j;
+        }
+        if (j == large.size())
+        {
+            break;
+        }
+        if (large[j] == id)
+        {
+            result.push_back(id);
+        }
+    }
+    return result;
+}
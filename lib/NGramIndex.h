@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Alphabet.h"
+#include "NGramCounts.h"
+#include "NGramKey.h"
+#include "WordArena.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//! An inverted index from n-grams to the words that contain them.
+//!
+//! Each word gets an id from 0 in order of decreasing weight, ties keeping the order of the word list, so a list of ids in
+//! increasing order is also a list of words by decreasing weight. Each normalized n-gram that the index's alphabet can
+//! pack (see Alphabet::pack()) has a posting list: the ids of the words containing it, in increasing order, stored as the
+//! differences between consecutive ids, each encoded as a varint of 7 bits per byte, low bits first. The packed n-grams
+//! are kept sorted, so a posting list is found by binary search.
+class NGramIndex
+{
+public:
+    //! Constructs an empty index.
+    NGramIndex() = default;
+
+    //! Builds the index of a list of words, enumerating their n-grams on the specified number of threads and packing them
+    //! with an alphabet.
+    static NGramIndex build(WordList const & words, unsigned threads = 1, Alphabet const & alphabet = Alphabet::english());
+
+    //! Returns the number of words.
+    size_t size() const { return weights.size(); }
+
+    //! Returns the number of n-grams that have a posting list.
+    size_t ngrams() const { return keys.size(); }
+
+    //! Returns the size of the encoded posting lists, in bytes.
+    size_t postingBytes() const { return postingData.size(); }
+
+    //! Returns the word with an id.
+    std::string_view word(uint32_t id) const { return arena[id]; }
+
+    //! Returns the weight of the word with an id.
+    double weight(uint32_t id) const { return weights[id]; }
+
+    //! Returns the ids of the words containing a normalized n-gram, in increasing order.
+    //!
+    //! @return The ids, or none if the n-gram cannot be packed or no word contains it.
+    std::vector<uint32_t> postings(std::string_view ngram) const;
+
+    //! Returns the ids of the words containing every one of a list of normalized n-grams, in increasing order.
+    //!
+    //! The posting lists are intersected from the shortest, so the cost depends mostly on the rarest n-gram.
+    std::vector<uint32_t> wordsWithAll(std::vector<std::string> const & ngrams) const;
+
+    //! Returns the ids of the words containing a substring, as it is written, in increasing order.
+    //!
+    //! The candidates are the words containing the normalized n-grams of the substring's pieces that can be packed, and
+    //! each candidate is checked. If no piece can be packed, every word is checked.
+    std::vector<uint32_t> wordsContaining(std::string_view substring) const;
+
+private:
+    // Decodes the posting list at an index of keys
+    std::vector<uint32_t> decode(size_t index) const;
+
+    Alphabet              alphabet;    // Symbols the n-grams are packed with
+    WordArena             arena;       // The words, by id
+    std::vector<double>   weights;     // Weight of each word, by id
+    std::vector<NGramKey> keys;        // The packed n-grams, in increasing order
+    std::vector<size_t>   offsets;     // Offset of each n-gram's posting list in postingData, followed by its size
+    std::vector<uint8_t>  postingData; // The encoded posting lists
+};
+
+//! Intersects two lists of ids in increasing order.
+//!
+//! Each id of the shorter list is searched for in the longer one, which is skipped through four ids at a time and, where
+//! SSE2 is available, compared four ids at a time with vector compares.
+//!
+//! @return The ids in both lists, in increasing order.
+std::vector<uint32_t> intersectPostings(std::vector<uint32_t> const & a, std::vector<uint32_t> const & b);
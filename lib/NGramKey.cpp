@@ -0,0 +1,59 @@
+#include "NGramKey.h"
+
+#include <algorithm>
+
+namespace
+{
+
+// Returns the symbol with the specified code
+char symbolFromCode(unsigned code)
+{
+    return (code <= VOWELS.size()) ? VOWELS[code - 1] : CONSONANTS[code - 1 - VOWELS.size()];
+}
+
+} // anonymous namespace
+
+//! @param  word    The word to check.
+//!
+//! @return true if every character of the word has a symbol code.
+bool isPackable(std::string_view word)
+{
+    return std::all_of(word.begin(), word.end(), [](char c) { return symbolCode(c) != 0; });
+}
+
+//! @param  ngram   A normalized n-gram.
+//!
+//! @return The key, or 0 if the n-gram cannot be packed.
+NGramKey packNGram(std::string_view ngram)
+{
+    if (ngram.empty() || ngram.size() > MAX_PACKED_NGRAM_LENGTH)
+    {
+        return 0;
+    }
+
+    NGramKey key = 0;
+    for (char c : ngram)
+    {
+        unsigned code = symbolCode(c);
+        if (code == 0)
+        {
+            return 0;
+        }
+        key = (key << NGRAM_KEY_SYMBOL_BITS) | code;
+    }
+    return key;
+}
+
+//! @param  key     A key created by packNGram().
+//!
+//! @return The n-gram.
+std::string unpackNGram(NGramKey key)
+{
+    std::string ngram(packedLength(key), '\0');
+    for (auto it = ngram.rbegin(); it != ngram.rend(); ++it)
+    {
+        *it = symbolFromCode(static_cast<unsigned>(key & ((1u << NGRAM_KEY_SYMBOL_BITS) - 1)));
+        key >>= NGRAM_KEY_SYMBOL_BITS;
+    }
+    return ngram;
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "NGramCounts.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+
+//! An n-gram packed into an integer.
+//!
+//! Each symbol of the normalized alphabet (VOWELS and CONSONANTS) is assigned a code from 1 to 29, and the codes of an
+//! n-gram's symbols are packed into consecutive 5-bit fields, first symbol most significant. Because no symbol has the
+//! code 0, the key of an n-gram is unique across all lengths, its length can be recovered from the key, and sorting keys
+//! sorts n-grams by length and then by symbol code.
+typedef uint64_t NGramKey;
+
+//! A packed n-gram and a weight.
+struct KeyedWeight
+{
+    NGramKey key;    //!< The packed n-gram
+    double   weight; //!< The weight
+};
+
+//! Number of bits used by each symbol in an NGramKey.
+inline constexpr unsigned NGRAM_KEY_SYMBOL_BITS = 5;
+//! Maximum length of an n-gram that can be packed into an NGramKey.
+inline constexpr size_t MAX_PACKED_NGRAM_LENGTH = (sizeof(NGramKey) * 8) / NGRAM_KEY_SYMBOL_BITS;
+
+namespace NGramKeyDetail
+{
+
+// Maps each character to its symbol code, or 0 if it is not in the normalized alphabet
+constexpr std::array<uint8_t, 256> makeSymbolCodes()
+{
+    std::array<uint8_t, 256> codes{};
+    uint8_t                  code = 0;
+    for (char c : VOWELS)
+    {
+        codes[static_cast<unsigned char>(c)] = ++code;
+    }
+    for (char c : CONSONANTS)
+    {
+        codes[static_cast<unsigned char>(c)] = ++code;
+    }
+    return codes;
+}
+
+inline constexpr std::array<uint8_t, 256> SYMBOL_CODES = makeSymbolCodes();
+
+// Returns true if 'y' following c is replaced by 'Y'
+constexpr bool precedesVowelY(char c)
+{
+    return c == 'a' || c == 'e' || c == 'o' || c == 'u' || CONSONANTS.find(c) != std::string_view::npos;
+}
+
+// Returns true if 'w' following c is replaced by 'W'
+constexpr bool precedesVowelW(char c)
+{
+    return c == 'a' || c == 'e' || c == 'o';
+}
+
+} // namespace NGramKeyDetail
+
+//! Returns the symbol code of a character, or 0 if the character is not in the normalized alphabet.
+inline unsigned symbolCode(char c)
+{
+    return NGramKeyDetail::SYMBOL_CODES[static_cast<unsigned char>(c)];
+}
+
+//! Returns the number of symbols in a packed n-gram.
+inline size_t packedLength(NGramKey key)
+{
+    size_t length = 0;
+    for (; key != 0; key >>= NGRAM_KEY_SYMBOL_BITS)
+    {
+        ++length;
+    }
+    return length;
+}
+
+//! Returns true if every character of the word is in the normalized alphabet, so its n-grams can be packed.
+bool isPackable(std::string_view word);
+
+//! Packs a normalized n-gram into a key.
+//!
+//! @return The key, or 0 if the n-gram is empty, too long, or contains a character that is not in the normalized alphabet.
+NGramKey packNGram(std::string_view ngram);
+
+//! Unpacks a key created by packNGram().
+std::string unpackNGram(NGramKey key);
+
+namespace NGramKeyDetail
+{
+
+// Walks the normalized substrings of a word as forEachNormalizedNGram() does, packing them with a table of symbol codes of
+// the specified width. Substrings longer than maxLength have the key 0.
+template <typename Visitor>
+void walkNormalizedNGrams(std::string_view word, uint8_t const * codes, unsigned bits, size_t maxLength, Visitor && visit)
+{
+    size_t const wordLength = word.size();
+    for (size_t start = 0; start < wordLength; ++start)
+    {
+        // Walk the substrings starting at this position, one replacement token at a time. A token is a single character
+        // or a two-character sequence that is replaced. A substring ending in the middle of a two-character token ends
+        // with its first character unreplaced.
+        NGramKey key    = 0;
+        size_t   length = 0;
+        auto     push   = [&](char c)
+        {
+            ++length;
+            key = (length <= maxLength) ? (key << bits) | codes[static_cast<unsigned char>(c)] : 0;
+        };
+
+        size_t p = start;
+        while (p < wordLength)
+        {
+            char c0 = word[p];
+            char c1 = (p + 1 < wordLength) ? word[p + 1] : '\0';
+
+            // The substring ending at c0 always ends with c0 itself
+            NGramKey prefixKey    = key;
+            size_t   prefixLength = length;
+            push(c0);
+            visit(key, length, start, p + 1 - start);
+
+            if ((c1 == 'y' && precedesVowelY(c0)) || (c1 == 'w' && precedesVowelW(c0)))
+            {
+                push(c1 == 'y' ? 'Y' : 'W');
+                visit(key, length, start, p + 2 - start);
+                p += 2;
+            }
+            else if (c0 == 'q' && c1 == 'u')
+            {
+                key    = prefixKey;
+                length = prefixLength;
+                push('Q');
+                visit(key, length, start, p + 2 - start);
+                p += 2;
+            }
+            else
+            {
+                p += 1;
+            }
+        }
+    }
+}
+
+} // namespace NGramKeyDetail
+
+//! Calls a visitor for the normalized form of every substring of a word.
+//!
+//! The result is the same as calling replaceSpecialSequences() on every substring, but the substrings starting at each
+//! position are normalized incrementally and packed without allocating. The visitor is called as
+//! visit(key, length, start, rawLength), where length is the normalized length and start and rawLength locate the substring
+//! in the word. If the normalized length is greater than MAX_PACKED_NGRAM_LENGTH, key is 0 and the visitor must normalize
+//! the substring itself. The word must be packable (see isPackable()).
+template <typename Visitor>
+void forEachNormalizedNGram(std::string_view word, Visitor && visit)
+{
+    NGramKeyDetail::walkNormalizedNGrams(word,
+                                         NGramKeyDetail::SYMBOL_CODES.data(),
+                                         NGRAM_KEY_SYMBOL_BITS,
+                                         MAX_PACKED_NGRAM_LENGTH,
+                                         std::forward<Visitor>(visit));
+}
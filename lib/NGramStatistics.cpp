@@ -0,0 +1,102 @@
+#include "NGramStatistics.h"
+
+#include "Parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <string_view>
+#include <utility>
+
+namespace
+{
+
+// Returns w * log2(w), or 0 if w is not positive
+double weightLog(double w)
+{
+    return (w > 0.0) ? w * std::log2(w) : 0.0;
+}
+
+// Computes the statistics of one length from its entries sorted by n-gram
+NGramStatistics lengthStatistics(std::vector<std::pair<std::string_view, double>> const & entries, double total)
+{
+    NGramStatistics statistics;
+    if (total <= 0.0 || entries.empty())
+    {
+        return statistics;
+    }
+
+    // Sorted entries with the same prefix (the n-gram without its last symbol) are adjacent, so the weights of the prefixes
+    // are summed in the same pass
+    double sum          = 0.0; // Sum of the weights
+    double ngramSum     = 0.0; // Sum of w log2 w over the n-grams
+    double prefixSum    = 0.0; // Sum of w log2 w over the prefixes
+    double prefixWeight = 0.0;
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        auto const & [ngram, weight] = entries[i];
+        sum += weight;
+        ngramSum += weightLog(weight);
+        prefixWeight += weight;
+
+        bool const lastOfPrefix = i + 1 == entries.size() ||
+                                  entries[i + 1].first.substr(0, ngram.size() - 1) != ngram.substr(0, ngram.size() - 1);
+        if (lastOfPrefix)
+        {
+            prefixSum += weightLog(prefixWeight);
+            prefixWeight = 0.0;
+        }
+    }
+
+    statistics.entropy            = (sum * std::log2(total) - ngramSum) / total;
+    statistics.conditionalEntropy = (prefixSum - ngramSum) / total;
+    statistics.perplexity         = std::exp2(statistics.conditionalEntropy);
+    return statistics;
+}
+
+} // anonymous namespace
+
+//! With p = w / T for each weight w of a length whose total weight is T, H = -sum(p log2 p) = (W log2 T - S) / T, where W is
+//! the sum of the weights and S is the sum of w log2 w. The conditional entropy is the entropy of the n-grams minus the
+//! entropy of their prefixes, (S' - S) / T, where S' is the sum of w log2 w over the summed weights of each prefix.
+//!
+//! @param  counts  The n-gram counts.
+//! @param  threads Number of threads to use.
+//!
+//! @return The statistics of each length.
+std::vector<NGramStatistics> computeStatistics(NGramCounts const & counts, unsigned threads)
+{
+    size_t const lengths = counts.ngramMaps.size();
+
+    // Hand out the lengths, largest table first, to whichever thread is free. Each length is computed by a single thread, so
+    // the result does not depend on the number of threads.
+    std::vector<size_t> order(lengths);
+    for (size_t n = 0; n < lengths; ++n)
+    {
+        order[n] = n;
+    }
+    std::stable_sort(order.begin(),
+                     order.end(),
+                     [&counts](size_t a, size_t b) { return counts.ngramMaps[b].size() < counts.ngramMaps[a].size(); });
+
+    std::vector<NGramStatistics> statistics(lengths);
+    std::atomic<size_t>          next{0};
+    threads = std::max(1u, std::min<unsigned>(threads, static_cast<unsigned>(std::max<size_t>(lengths, 1))));
+    runParallel(threads,
+                [&](unsigned)
+                {
+                    for (size_t i = next++; i < lengths; i = next++)
+                    {
+                        // Freeze the table into an array sorted by n-gram
+                        size_t const                                     n = order[i];
+                        std::vector<std::pair<std::string_view, double>> entries(counts.ngramMaps[n].begin(),
+                                                                                 counts.ngramMaps[n].end());
+                        std::sort(entries.begin(), entries.end());
+                        if (n > 0)
+                        {
+                            statistics[n] = lengthStatistics(entries, counts.totalWeights[n]);
+                        }
+                    }
+                });
+    return statistics;
+}
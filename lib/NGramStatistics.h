@@ -0,0 +1,31 @@
+#pragma once
+
+#include "NGramCounts.h"
+
+#include <cstddef>
+#include <vector>
+
+//! Information-theoretic statistics of the n-grams of one length.
+//!
+//! The probability of an n-gram is its weight divided by the total weight of the n-grams of its length, as in the reported
+//! percentages. If the counts were pruned, the probabilities of the remaining n-grams sum to less than 1. The conditional
+//! entropy is computed within each length, from the n-grams and their prefixes (the n-grams without their last symbols),
+//! because the tables of different lengths are not marginals of each other: a word contributes fewer n-grams to the longer
+//! lengths.
+struct NGramStatistics
+{
+    double entropy            = 0.0; //!< Shannon entropy H(X1..Xn) of the n-grams, in bits
+    double conditionalEntropy = 0.0; //!< H(Xn | X1..Xn-1) of the last symbol given the others, in bits
+    double perplexity         = 1.0; //!< Perplexity of the next symbol given the previous n - 1, 2 ^ conditionalEntropy
+};
+
+//! Computes the statistics of every n-gram length.
+//!
+//! Each length's table is frozen into an array sorted by n-gram, so that the n-grams sharing a prefix are adjacent. The
+//! lengths are divided among the threads.
+//!
+//! @param  counts  The n-gram counts.
+//! @param  threads Number of threads to use.
+//!
+//! @return The statistics, indexed by n-gram length like counts.ngramMaps.
+std::vector<NGramStatistics> computeStatistics(NGramCounts const & counts, unsigned threads = 1);
@@ -0,0 +1,194 @@
+#include "NGramTable.h"
+
+#include "Alphabet.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+// Smallest number of slots, as a power of two
+unsigned const MIN_SLOT_BITS = 4;
+
+// Hints that a slot is about to be written
+inline void prefetchForWrite(void const * address)
+{
+#if defined(__GNUC__)
+    __builtin_prefetch(address, 1);
+#else
+    (void)address;
+#endif
+}
+
+} // anonymous namespace
+
+//! @param  expectedEntries Number of entries the table should hold without growing.
+NGramTable::NGramTable(size_t expectedEntries)
+    : count(0)
+{
+    // Keep the table at most half full
+    unsigned bits = MIN_SLOT_BITS;
+    while ((size_t(1) << bits) < expectedEntries * 2)
+    {
+        ++bits;
+    }
+    slots.assign(size_t(1) << bits, KeyedWeight{0, 0.0});
+    shift = 64 - bits;
+}
+
+//! @param  key     The n-gram. Must not be 0.
+//! @param  weight  The weight to add.
+void NGramTable::add(NGramKey key, double weight)
+{
+    addFrom(home(key), key, weight);
+    if (count * 2 > slots.size())
+    {
+        grow();
+    }
+}
+
+//! The table grows before each window if necessary, so that the slots computed for the window stay valid while it is added.
+//!
+//! @param  entries The n-grams and the weights to add. The keys must not be 0.
+//! @param  n       Number of entries.
+void NGramTable::addBatch(KeyedWeight const * entries, size_t n)
+{
+    size_t homes[ADD_BATCH_WINDOW];
+    for (size_t begin = 0; begin < n; begin += ADD_BATCH_WINDOW)
+    {
+        size_t const end = std::min(n, begin + ADD_BATCH_WINDOW);
+        while ((count + end - begin) * 2 > slots.size())
+        {
+            grow();
+        }
+        for (size_t i = begin; i < end; ++i)
+        {
+            homes[i - begin] = home(entries[i].key);
+            prefetchForWrite(&slots[homes[i - begin]]);
+        }
+        for (size_t i = begin; i < end; ++i)
+        {
+            addFrom(homes[i - begin], entries[i].key, entries[i].weight);
+        }
+    }
+}
+
+//! @param  i       Index of the slot where probing begins.
+//! @param  key     The n-gram. Must not be 0.
+//! @param  weight  The weight to add.
+void NGramTable::addFrom(size_t i, NGramKey key, double weight)
+{
+    size_t const mask = slots.size() - 1;
+    for (;; i = (i + 1) & mask)
+    {
+        KeyedWeight & slot = slots[i];
+        if (slot.key == key)
+        {
+            slot.weight += weight;
+            return;
+        }
+        if (slot.key == 0)
+        {
+            slot = {key, weight};
+            ++count;
+            return;
+        }
+    }
+}
+
+//! @param  key The n-gram.
+//!
+//! @return The weight of the n-gram, or 0 if it is not in the table.
+double NGramTable::weight(NGramKey key) const
+{
+    size_t const mask = slots.size() - 1;
+    for (size_t i = home(key);; i = (i + 1) & mask)
+    {
+        if (slots[i].key == key)
+        {
+            return slots[i].weight;
+        }
+        if (slots[i].key == 0)
+        {
+            return 0.0;
+        }
+    }
+}
+
+//! @param  key The n-gram.
+//!
+//! @return A pointer to the weight of the n-gram, valid until the table is changed, or nullptr if it is not in the table.
+double const * NGramTable::find(NGramKey key) const
+{
+    size_t const mask = slots.size() - 1;
+    for (size_t i = home(key);; i = (i + 1) & mask)
+    {
+        if (slots[i].key == key)
+        {
+            return &slots[i].weight;
+        }
+        if (slots[i].key == 0)
+        {
+            return nullptr;
+        }
+    }
+}
+
+//! @param  other   The table to add.
+void NGramTable::merge(NGramTable const & other)
+{
+    std::vector<KeyedWeight> batch;
+    batch.reserve(ADD_BATCH_WINDOW);
+    other.forEach(
+        [&](NGramKey key, double weight)
+        {
+            batch.push_back({key, weight});
+            if (batch.size() == ADD_BATCH_WINDOW)
+            {
+                addBatch(batch.data(), batch.size());
+                batch.clear();
+            }
+        });
+    addBatch(batch.data(), batch.size());
+}
+
+//! @param  counts  The counts to add to.
+void NGramTable::addTo(NGramCounts & counts) const
+{
+    forEach(
+        [&counts](NGramKey key, double weight)
+        {
+            size_t length = packedLength(key);
+            counts.extend(length);
+            counts.ngramMaps[length][unpackNGram(key)] += weight;
+        });
+}
+
+//! @param  counts      The counts to add to.
+//! @param  alphabet    The alphabet the keys were packed with.
+void NGramTable::addTo(NGramCounts & counts, Alphabet const & alphabet) const
+{
+    forEach(
+        [&](NGramKey key, double weight)
+        {
+            size_t length = alphabet.packedLength(key);
+            counts.extend(length);
+            counts.ngramMaps[length][alphabet.unpack(key)] += weight;
+        });
+}
+
+void NGramTable::grow()
+{
+    std::vector<KeyedWeight> old = std::exchange(slots, std::vector<KeyedWeight>(slots.size() * 2, KeyedWeight{0, 0.0}));
+    --shift;
+    count = 0;
+    for (auto const & slot : old)
+    {
+        if (slot.key != 0)
+        {
+            add(slot.key, slot.weight);
+        }
+    }
+}
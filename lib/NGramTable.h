@@ -0,0 +1,78 @@
+#pragma once
+
+#include "NGramKey.h"
+#include "NGramCounts.h"
+
+#include <cstddef>
+#include <vector>
+
+class Alphabet;
+
+//! Hash table mapping packed n-grams to weights.
+//!
+//! The table uses open addressing with linear probing over a power-of-two array of (key, weight) slots, so a lookup usually
+//! touches a single cache line. Key 0 marks an empty slot, which is never a valid NGramKey. The table grows when it is half
+//! full.
+class NGramTable
+{
+public:
+    //! Number of entries of a batch whose slots are prefetched together by addBatch().
+    static constexpr size_t ADD_BATCH_WINDOW = 32;
+
+    //! Constructs a table with room for the specified number of entries before it must grow.
+    explicit NGramTable(size_t expectedEntries = 0);
+
+    //! Adds a weight to an n-gram, inserting it if necessary.
+    void add(NGramKey key, double weight);
+
+    //! Adds the weights of a batch of n-grams, as add() does for each of them in order.
+    //!
+    //! The entries are added in windows of ADD_BATCH_WINDOW. The slots where the keys of a window begin probing are computed
+    //! and prefetched before any of them is updated, so that the cache misses of the window overlap instead of stalling each
+    //! add in turn. Useful when the table is larger than the cache.
+    void addBatch(KeyedWeight const * entries, size_t n);
+
+    //! Returns the weight of an n-gram, or 0 if it is not in the table.
+    double weight(NGramKey key) const;
+
+    //! Returns a pointer to the weight of an n-gram, or nullptr if it is not in the table.
+    double const * find(NGramKey key) const;
+
+    //! Returns the number of n-grams in the table.
+    size_t size() const { return count; }
+
+    //! Adds the weights of another table to this table.
+    void merge(NGramTable const & other);
+
+    //! Calls visit(key, weight) for every n-gram in the table, in no particular order.
+    template <typename Visitor>
+    void forEach(Visitor && visit) const
+    {
+        for (auto const & slot : slots)
+        {
+            if (slot.key != 0)
+            {
+                visit(slot.key, slot.weight);
+            }
+        }
+    }
+
+    //! Adds the n-grams of the table to a set of counts, without changing the total weights.
+    void addTo(NGramCounts & counts) const;
+
+    //! Adds the n-grams of the table, packed with an alphabet, to a set of counts, without changing the total weights.
+    void addTo(NGramCounts & counts, Alphabet const & alphabet) const;
+
+private:
+    // Returns the slot index where probing for a key begins
+    size_t home(NGramKey key) const { return static_cast<size_t>((key * 0x9e3779b97f4a7c15ull) >> shift); }
+
+    // Adds a weight to an n-gram, probing from the specified slot. The table must have room for one more entry.
+    void addFrom(size_t i, NGramKey key, double weight);
+
+    void grow();
+
+    std::vector<KeyedWeight> slots; // Power-of-two array of slots
+    size_t                   count; // Number of occupied slots
+    unsigned                 shift; // 64 - log2(number of slots)
+};
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+//! Formats sections of output on several threads and writes them to a stream in order.
+//!
+//! Worker threads take the sections in order and call format(i, section) to format section i into a private buffer. The
+//! calling thread writes each buffer to the stream with a single write as soon as it and every section before it are
+//! formatted, so the output is the same as formatting the sections in order on one thread. At most twice as many sections
+//! as threads are formatted ahead of the one being written, which bounds the memory held by the buffers. With one thread,
+//! the sections are formatted straight into the stream.
+//!
+//! @param out      The stream to write to.
+//! @param sections Number of sections.
+//! @param threads  Number of threads formatting the sections.
+//! @param format   Called as format(i, section) to format section i into the std::ostream section.
+template <typename Format>
+void writeOrdered(std::ostream & out, size_t sections, unsigned threads, Format && format)
+{
+    if (threads <= 1 || sections <= 1)
+    {
+        for (size_t i = 0; i < sections; ++i)
+        {
+            format(i, out);
+        }
+        return;
+    }
+
+    size_t const                            window = 2 * static_cast<size_t>(threads);
+    std::vector<std::optional<std::string>> buffers(sections);
+    std::mutex                              mutex;
+    std::condition_variable                 formatted; // A section is formatted
+    std::condition_variable                 written;   // A section is written
+    size_t                                  next    = 0; // Next section to format
+    size_t                                  writing = 0; // Next section to write
+
+    auto const work = [&]
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (next < sections)
+        {
+            size_t const i = next++;
+            written.wait(lock, [&] { return i < writing + window; });
+            lock.unlock();
+
+            std::ostringstream section;
+            format(i, section);
+
+            lock.lock();
+            buffers[i] = section.str();
+            formatted.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (unsigned t = 0; t < threads; ++t)
+    {
+        workers.emplace_back(work);
+    }
+    for (size_t i = 0; i < sections; ++i)
+    {
+        std::string buffer;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            formatted.wait(lock, [&] { return buffers[i].has_value(); });
+            buffer = std::move(*buffers[i]);
+            buffers[i].reset();
+        }
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            writing = i + 1;
+        }
+        written.notify_all();
+    }
+    for (auto & worker : workers)
+    {
+        worker.join();
+    }
+}
+
+//! Writes the items of the innermost array of a JsonWriter or a BinaryWriter, formatting them on several threads.
+//!
+//! Each item is written by a writer continuing the document of the array's writer, into its own section of writeOrdered().
+//!
+//! @param writer       The writer, whose innermost open container is an array with no items yet.
+//! @param out          The stream the writer writes to.
+//! @param items        Number of items.
+//! @param threads      Number of threads formatting the items.
+//! @param writeItem    Called as writeItem(itemWriter, i) to write item i.
+template <typename Writer, typename WriteItem>
+void writeItemsOrdered(Writer & writer, std::ostream & out, size_t items, unsigned threads, WriteItem && writeItem)
+{
+    writer.flush();
+    writeOrdered(out,
+                 items,
+                 threads,
+                 [&](size_t i, std::ostream & section)
+                 {
+                     Writer itemWriter(section, writer, i);
+                     writeItem(itemWriter, i);
+                 });
+    writer.skipItems(items);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+//! Default size of an OutputBuffer, in bytes.
+inline constexpr size_t OUTPUT_BUFFER_SIZE = size_t(1) << 20;
+
+//! Collects output in memory and writes it to a stream in large blocks.
+//!
+//! Text is appended to the buffer, and the buffer is written to the stream with a single write whenever the next text does
+//! not fit, when flush() is called and when the buffer is destroyed.
+class OutputBuffer
+{
+public:
+    //! Constructs a buffer that writes to a stream once it holds the specified number of bytes (at least 64).
+    explicit OutputBuffer(std::ostream & out, size_t capacity = OUTPUT_BUFFER_SIZE)
+        : out(out)
+        , capacity(std::max<size_t>(capacity, 64))
+    {
+        buffer.reserve(this->capacity);
+    }
+
+    //! Writes what is left in the buffer to the stream.
+    ~OutputBuffer() { flush(); }
+
+    OutputBuffer(OutputBuffer const &)             = delete;
+    OutputBuffer & operator=(OutputBuffer const &) = delete;
+
+    //! Appends text.
+    void append(std::string_view text)
+    {
+        if (buffer.size() + text.size() > capacity)
+        {
+            flush();
+        }
+        buffer.append(text);
+    }
+
+    //! Appends a character.
+    void append(char c)
+    {
+        if (buffer.size() == capacity)
+        {
+            flush();
+        }
+        buffer.push_back(c);
+    }
+
+    //! Writes the contents of the buffer to the stream.
+    void flush()
+    {
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+
+private:
+    std::ostream & out;      // The stream written to
+    std::string    buffer;   // Output not written to the stream yet
+    size_t         capacity; // Size at which the buffer is written
+};
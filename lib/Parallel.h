@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+//! Calls task(t) for t = 0 .. threads - 1, each on its own thread, and waits for all of them to finish.
+//!
+//! Task 0 runs on the calling thread.
+template <typename Task>
+void runParallel(unsigned threads, Task && task)
+{
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (unsigned t = 1; t < threads; ++t)
+    {
+        workers.emplace_back([&task, t] { task(t); });
+    }
+    if (threads > 0)
+    {
+        task(0u);
+    }
+    for (auto & worker : workers)
+    {
+        worker.join();
+    }
+}
+
+//! Returns the beginning of slice t when count items are split into the specified number of contiguous slices.
+inline size_t sliceBegin(size_t count, unsigned t, unsigned slices)
+{
+    return count * t / slices;
+}
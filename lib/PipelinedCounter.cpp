@@ -0,0 +1,100 @@
+#include "PipelinedCounter.h"
+
+#include <algorithm>
+#include <utility>
+
+//! @param  options         Counting options.
+//! @param  batchSize       Number of words in each batch.
+//! @param  queueCapacity   Maximum number of batches waiting to be counted.
+PipelinedCounter::PipelinedCounter(CountingOptions const & options, size_t batchSize, size_t queueCapacity)
+    : options(options)
+    , batchSize(std::max<size_t>(batchSize, 1))
+    , queue(queueCapacity)
+{
+    unsigned const threads = std::max(1u, options.threads);
+    counts.resize(threads);
+    errors.resize(threads);
+    batch.reserve(this->batchSize);
+
+    // Each thread counts whole batches on its own, so the engine runs single-threaded. The threshold must see every word, so
+    // it is applied by finish().
+    CountingOptions batchOptions = options;
+    batchOptions.threads         = 1;
+    batchOptions.minWeight       = 0.0;
+    workers.reserve(threads);
+    for (unsigned t = 0; t < threads; ++t)
+    {
+        workers.emplace_back(
+            [this, t, batchOptions]
+            {
+                try
+                {
+                    while (auto words = queue.pop())
+                    {
+                        countNGrams(counts[t], *words, 0, words->size(), batchOptions);
+                    }
+                }
+                catch (...)
+                {
+                    errors[t] = std::current_exception();
+                    queue.close(); // Stop the producer from waiting on a queue that is no longer drained
+                }
+            });
+    }
+}
+
+PipelinedCounter::~PipelinedCounter()
+{
+    stop();
+}
+
+//! @param  word    The word.
+//! @param  weight  The weight of the word.
+void PipelinedCounter::add(std::string_view word, double weight)
+{
+    batch.emplace_back(word, weight);
+    ++wordCount;
+    totalWeight += weight;
+    if (batch.size() == batchSize)
+    {
+        queue.push(std::exchange(batch, WordList()));
+        batch.reserve(batchSize);
+    }
+}
+
+//! @return The counts of every word added.
+NGramCounts PipelinedCounter::finish()
+{
+    if (!batch.empty())
+    {
+        queue.push(std::exchange(batch, WordList()));
+    }
+    stop();
+    for (auto const & error : errors)
+    {
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+    NGramCounts result = std::move(counts[0]);
+    for (size_t t = 1; t < counts.size(); ++t)
+    {
+        result.merge(counts[t]);
+    }
+    result.prune(options.minWeight);
+    return result;
+}
+
+void PipelinedCounter::stop()
+{
+    queue.close();
+    for (auto & worker : workers)
+    {
+        if (worker.joinable())
+        {
+            worker.join();
+        }
+    }
+}
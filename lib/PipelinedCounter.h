@@ -0,0 +1,71 @@
+#pragma once
+
+#include "BoundedQueue.h"
+#include "NGramCounter.h"
+#include "NGramCounts.h"
+
+#include <cstddef>
+#include <exception>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+//! Counts the n-grams of words as they are produced, overlapping the production of the words with their counting.
+//!
+//! The producer calls add() for each word, typically while it is still reading its input. The words are collected into
+//! batches that pass through a bounded queue to options.threads counting threads, each of which counts the batches it takes
+//! into its own counts. finish() merges the threads' counts in thread order and applies options.minWeight to the merged
+//! counts. Because the assignment of batches to threads varies, the result may differ from run to run by floating-point
+//! rounding.
+//!
+//! Example usage:
+//! @code
+//! PipelinedCounter counter(options);
+//! for (auto const & [word, weight] : input)
+//!     counter.add(word, weight);
+//! NGramCounts counts = counter.finish();
+//! @endcode
+class PipelinedCounter
+{
+public:
+    //! Constructs a counter and starts its counting threads.
+    //!
+    //! @param options          Counting options. Each counting thread counts its batches with the engine on one thread.
+    //! @param batchSize        Number of words in each batch.
+    //! @param queueCapacity    Maximum number of batches waiting to be counted.
+    explicit PipelinedCounter(CountingOptions const & options, size_t batchSize = 1024, size_t queueCapacity = 16);
+
+    //! Stops the counting threads, discarding the counts if finish() was not called.
+    ~PipelinedCounter();
+
+    PipelinedCounter(PipelinedCounter const &)             = delete;
+    PipelinedCounter & operator=(PipelinedCounter const &) = delete;
+
+    //! Adds a word to be counted. Waits if the queue of batches is full.
+    void add(std::string_view word, double weight);
+
+    //! Waits for every word to be counted and returns the counts.
+    //!
+    //! @throws Rethrows the first exception thrown by a counting thread.
+    NGramCounts finish();
+
+    //! Returns the number of words added.
+    size_t words() const { return wordCount; }
+
+    //! Returns the total weight of the words added.
+    double weight() const { return totalWeight; }
+
+private:
+    // Stops accepting batches and waits for the counting threads
+    void stop();
+
+    CountingOptions                 options;           // Options, with the threshold applied by finish()
+    size_t                          batchSize;         // Number of words in each batch
+    WordList                        batch;             // The batch being filled
+    BoundedQueue<WordList>          queue;             // Batches waiting to be counted
+    std::vector<NGramCounts>        counts;            // Counts of each counting thread
+    std::vector<std::exception_ptr> errors;            // Exception thrown by each counting thread, if any
+    std::vector<std::thread>        workers;           // The counting threads
+    size_t                          wordCount   = 0;   // Number of words added
+    double                          totalWeight = 0.0; // Total weight of the words added
+};
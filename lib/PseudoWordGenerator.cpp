@@ -0,0 +1,176 @@
+#include "PseudoWordGenerator.h"
+
+#include "Parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+
+// Number of words generated with each random number generator
+size_t const BLOCK_SIZE = 4096;
+
+// Returns a mask of the last length symbols of a key
+NGramKey lastSymbolsMask(size_t length)
+{
+    return (length == 0) ? 0 : (NGramKey(1) << (NGRAM_KEY_SYMBOL_BITS * length)) - 1;
+}
+
+// Returns the character of each symbol code
+std::string symbolsByCode()
+{
+    std::string symbols(1, '\0');
+    symbols.append(VOWELS);
+    symbols.append(CONSONANTS);
+    return symbols;
+}
+
+} // anonymous namespace
+
+//! The weight of the words of length at least n is T(n) - T(n + 1), where T(n) is the total weight of the n-grams of
+//! length n, so the weight of the words of length exactly n is T(n) - 2 T(n + 1) + T(n + 2). The weights are exact when
+//! normalization does not change the lengths of the substrings ("qu" does), and negative weights are treated as 0.
+//!
+//! @param  counts  The n-gram counts.
+//! @param  order   Order of the generator.
+//!
+//! @return The generator.
+//!
+//! @throws std::invalid_argument if the order is out of range or there is nothing to generate words from.
+PseudoWordGenerator PseudoWordGenerator::build(NGramCounts const & counts, size_t order)
+{
+    if (order < 1 || order > MAX_PACKED_NGRAM_LENGTH)
+    {
+        throw std::invalid_argument("Generator order must be from 1 to " + std::to_string(MAX_PACKED_NGRAM_LENGTH) + ".");
+    }
+
+    PseudoWordGenerator generator;
+
+    auto const totalWeight = [&counts](size_t n) { return (n < counts.totalWeights.size()) ? counts.totalWeights[n] : 0.0; };
+    std::vector<double> lengthWeights;
+    for (size_t n = 1; n < counts.totalWeights.size(); ++n)
+    {
+        lengthWeights.push_back(totalWeight(n) - 2 * totalWeight(n + 1) + totalWeight(n + 2));
+    }
+    generator.lengths = AliasTable(lengthWeights);
+
+    size_t const available = counts.ngramMaps.empty() ? 0 : counts.ngramMaps.size() - 1;
+    generator.generatorOrder = std::max<size_t>(std::min(order, available), 1);
+
+    // Group the k-grams of each length by context, the k - 1 symbols before the last. Sorting the keys puts the k-grams of
+    // a context next to each other, and the empty context (of the unigrams) comes first.
+    for (size_t k = 1; k <= available && k <= generator.generatorOrder; ++k)
+    {
+        std::vector<KeyedWeight> entries;
+        entries.reserve(counts.ngramMaps[k].size());
+        for (auto const & [ngram, weight] : counts.ngramMaps[k])
+        {
+            NGramKey key = packNGram(ngram);
+            if (key != 0 && weight > 0.0)
+            {
+                entries.push_back({key, weight});
+            }
+        }
+        std::sort(entries.begin(), entries.end(), [](auto const & a, auto const & b) { return a.key < b.key; });
+
+        for (size_t begin = 0, end = 0; begin < entries.size(); begin = end)
+        {
+            NGramKey const      context = entries[begin].key >> NGRAM_KEY_SYMBOL_BITS;
+            Successors          next;
+            std::vector<double> weights;
+            for (end = begin; end < entries.size() && (entries[end].key >> NGRAM_KEY_SYMBOL_BITS) == context; ++end)
+            {
+                next.codes.push_back(static_cast<uint8_t>(entries[end].key & lastSymbolsMask(1)));
+                weights.push_back(entries[end].weight);
+            }
+            next.table = AliasTable(weights);
+            if (k > 1)
+            {
+                generator.contexts.emplace(context, static_cast<uint32_t>(generator.successors.size()));
+            }
+            generator.successors.push_back(std::move(next));
+        }
+    }
+
+    if (generator.lengths.empty() || generator.successors.empty())
+    {
+        throw std::invalid_argument("There are no n-grams to generate words from.");
+    }
+    return generator;
+}
+
+//! @param  rng The random number generator.
+//!
+//! @return The word.
+std::string PseudoWordGenerator::generate(std::mt19937_64 & rng) const
+{
+    static std::string const symbols = symbolsByCode();
+
+    size_t const length  = lengths.sample(rng()) + 1;
+    NGramKey     context = 0;
+    size_t       known   = 0; // Number of symbols in the context
+    std::string  word;
+    word.reserve(length + 2);
+    for (size_t i = 0; i < length; ++i)
+    {
+        // Shorten the context until it was followed by a symbol. The empty context always was.
+        Successors const * next = &successors[0];
+        for (size_t m = known; m > 0; --m)
+        {
+            auto found = contexts.find(context & lastSymbolsMask(m));
+            if (found != contexts.end())
+            {
+                next = &successors[found->second];
+                break;
+            }
+        }
+
+        uint8_t const code = next->codes[next->table.sample(rng())];
+        char const    c    = symbols[code];
+        if (c == 'Q')
+        {
+            word += "qu";
+        }
+        else
+        {
+            word += (c == 'Y') ? 'y' : (c == 'W') ? 'w' : c;
+        }
+
+        known   = std::min(known + 1, generatorOrder - 1);
+        context = ((context << NGRAM_KEY_SYMBOL_BITS) | code) & lastSymbolsMask(known);
+    }
+    return word;
+}
+
+//! The threads take blocks of BLOCK_SIZE words in turn. The generator of block b is seeded with (seed, b).
+//!
+//! @param  count   Number of words to generate.
+//! @param  seed    The random seed.
+//! @param  threads Number of threads to use.
+//!
+//! @return The words.
+std::vector<std::string> PseudoWordGenerator::generate(size_t count, uint64_t seed, unsigned threads) const
+{
+    std::vector<std::string> words(count);
+    size_t const             blocks = (count + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    std::atomic<size_t>      nextBlock{0};
+    threads = std::max(1u, std::min<unsigned>(threads, static_cast<unsigned>(std::max<size_t>(blocks, 1))));
+    runParallel(threads,
+                [&](unsigned)
+                {
+                    for (size_t b = nextBlock++; b < blocks; b = nextBlock++)
+                    {
+                        std::seed_seq   sequence{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32),
+                                               static_cast<uint32_t>(b), static_cast<uint32_t>(uint64_t(b) >> 32)};
+                        std::mt19937_64 rng(sequence);
+                        for (size_t i = b * BLOCK_SIZE; i < std::min(count, (b + 1) * BLOCK_SIZE); ++i)
+                        {
+                            words[i] = generate(rng);
+                        }
+                    }
+                });
+    return words;
+}
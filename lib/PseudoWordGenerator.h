@@ -0,0 +1,73 @@
+#pragma once
+
+#include "AliasTable.h"
+#include "NGramCounts.h"
+#include "NGramKey.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//! Generates pseudo-words that follow the n-gram statistics of a set of counts.
+//!
+//! A generator of order k picks a word length, then picks each symbol of the word from the symbols that follow its
+//! context, the k - 1 symbols before it (fewer at the start of the word), in proportion to the weights of the k-grams. A
+//! context that was never followed by a symbol is shortened until one was. The word length is picked from the distribution
+//! of word lengths implied by the total weights: a word of length L contributes L - n + 1 n-grams of length n, so the
+//! second differences of the total weights give the weight of the words of each length.
+//!
+//! The distribution of the next symbol of every context and the length distribution are precomputed as alias tables, so
+//! each symbol costs one hash lookup and one constant-time sample. Generated words are written in plain letters: 'Q' is
+//! written "qu" and 'Y' and 'W' are written 'y' and 'w'.
+//!
+//! Example usage:
+//! @code
+//! PseudoWordGenerator generator = PseudoWordGenerator::build(counts, 3);
+//! std::vector<std::string> words = generator.generate(1000000, seed, threads);
+//! @endcode
+class PseudoWordGenerator
+{
+public:
+    //! Builds a generator from n-gram counts.
+    //!
+    //! @param counts   The n-gram counts. N-grams that cannot be packed are ignored.
+    //! @param order    Order of the generator, from 1 to MAX_PACKED_NGRAM_LENGTH. It is reduced if there are no counts of
+    //!                 the longer lengths.
+    //!
+    //! @throws std::invalid_argument if the order is out of range or the counts are empty.
+    static PseudoWordGenerator build(NGramCounts const & counts, size_t order);
+
+    //! Returns the order of the generator.
+    size_t order() const { return generatorOrder; }
+
+    //! Generates one word using a random number generator.
+    std::string generate(std::mt19937_64 & rng) const;
+
+    //! Generates words on several threads.
+    //!
+    //! The words are generated in blocks, each with its own random number generator seeded from the seed and the block
+    //! number, so the words depend only on the seed and not on the number of threads.
+    //!
+    //! @param count    Number of words to generate.
+    //! @param seed     The random seed.
+    //! @param threads  Number of threads to use.
+    std::vector<std::string> generate(size_t count, uint64_t seed, unsigned threads = 1) const;
+
+private:
+    // Next-symbol distribution of a context
+    struct Successors
+    {
+        std::vector<uint8_t> codes; // Symbol code of each index of the table
+        AliasTable           table; // Distribution of the indices
+    };
+
+    PseudoWordGenerator() = default;
+
+    size_t                                 generatorOrder = 1; // Order of the generator
+    AliasTable                             lengths;            // Distribution of the word length - 1
+    std::vector<Successors>                successors;         // Next-symbol distributions, the empty context first
+    std::unordered_map<NGramKey, uint32_t> contexts;           // Index in successors of each non-empty context
+};
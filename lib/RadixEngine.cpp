@@ -0,0 +1,96 @@
+// Radix-sort-and-reduce counting engine
+//
+// Every packed n-gram of every word is written with the word's weight into one array, which is then sorted by key with a
+// parallel LSD radix sort, and adjacent entries with equal keys are summed. There is no hashing and all memory accesses are
+// sequential. The n-grams are packed with the alphabet of the counting options, so any alphabet gets the same path. N-grams
+// that are too long to pack, and words with characters outside the alphabet, are counted with the hash engine instead.
+
+#include "NGramEngines.h"
+
+#include "Alphabet.h"
+#include "NGramKey.h"
+#include "Parallel.h"
+#include "RadixSort.h"
+
+#include <algorithm>
+#include <vector>
+
+//! @param  counts      Counts to add to.
+//! @param  words       The words and their weights.
+//! @param  begin       Index of the first word to count.
+//! @param  end         Index past the last word to count.
+//! @param  threads     Number of threads to use.
+//! @param  alphabet    Symbols the n-grams are packed with.
+void countWithRadixEngine(NGramCounts &    counts,
+                          WordList const & words,
+                          size_t           begin,
+                          size_t           end,
+                          unsigned         threads,
+                          Alphabet const & alphabet)
+{
+    size_t const count = end - begin;
+
+    // Each word of length L has L(L+1)/2 substrings. Compute where each word's entries start so that the words can be
+    // expanded in parallel directly into the array.
+    std::vector<size_t> offsets(count + 1, 0);
+    size_t              maxWordLength = 0;
+    for (size_t w = 0; w < count; ++w)
+    {
+        size_t length  = words[begin + w].first.size();
+        offsets[w + 1] = offsets[w] + length * (length + 1) / 2;
+        maxWordLength  = std::max(maxWordLength, length);
+    }
+    if (count > 0)
+    {
+        counts.extend(maxWordLength);
+    }
+
+    // Expand the words into (key, weight) entries. Entries that cannot be packed are counted separately and left as key 0,
+    // which sorts first and is skipped.
+    std::vector<KeyedWeight> entries(offsets.back());
+    std::vector<NGramCounts> unpacked(threads);
+    runParallel(threads,
+                [&](unsigned t)
+                {
+                    for (size_t w = sliceBegin(count, t, threads); w < sliceBegin(count, t + 1, threads); ++w)
+                    {
+                        auto const & [word, weight] = words[begin + w];
+                        KeyedWeight * out           = &entries[offsets[w]];
+                        if (!alphabet.isPackable(word))
+                        {
+                            unpacked[t].addWord(word, weight);
+                            std::fill(out, out + (offsets[w + 1] - offsets[w]), KeyedWeight{0, 0.0});
+                            continue;
+                        }
+                        std::string_view wordView = word;
+                        alphabet.forEachNormalizedNGram(wordView,
+                                                        [&](NGramKey key, size_t, size_t start, size_t rawLength)
+                                                        {
+                                                            if (key == 0)
+                                                            {
+                                                                std::string ngram = replaceSpecialSequences(
+                                                                    wordView.substr(start, rawLength));
+                                                                unpacked[t].addNGram(ngram, weight);
+                                                            }
+                                                            *out++ = {key, (key != 0) ? weight : 0.0};
+                                                        });
+                    }
+                });
+
+    radixSort(entries, threads);
+    reduceSorted(entries);
+
+    for (auto const & [key, weight] : entries)
+    {
+        if (key != 0)
+        {
+            size_t length = alphabet.packedLength(key);
+            counts.ngramMaps[length][alphabet.unpack(key)] += weight;
+            counts.totalWeights[length] += weight;
+        }
+    }
+    for (auto const & slice : unpacked)
+    {
+        counts.merge(slice);
+    }
+}
@@ -0,0 +1,106 @@
+#include "RadixSort.h"
+
+#include "Parallel.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+namespace
+{
+
+// Number of bits sorted in each pass
+unsigned const DIGIT_BITS = 8;
+size_t const   BUCKETS    = size_t(1) << DIGIT_BITS;
+
+typedef std::array<size_t, BUCKETS> Histogram;
+
+} // anonymous namespace
+
+//! @param  entries Entries to sort.
+//! @param  threads Number of threads to use.
+void radixSort(std::vector<KeyedWeight> & entries, unsigned threads)
+{
+    size_t const count = entries.size();
+    threads            = static_cast<unsigned>(std::clamp<size_t>(threads, 1, std::max<size_t>(count / BUCKETS, 1)));
+
+    NGramKey maxKey = 0;
+    for (auto const & entry : entries)
+    {
+        maxKey = std::max(maxKey, entry.key);
+    }
+
+    std::vector<KeyedWeight> buffer(count);
+    std::vector<Histogram>   histograms(threads);
+    for (unsigned shift = 0; shift < 64 && (maxKey >> shift) != 0; shift += DIGIT_BITS)
+    {
+        // Count the digits in each thread's slice
+        runParallel(threads,
+                    [&](unsigned t)
+                    {
+                        Histogram & histogram = histograms[t];
+                        histogram.fill(0);
+                        for (size_t i = sliceBegin(count, t, threads); i < sliceBegin(count, t + 1, threads); ++i)
+                        {
+                            ++histogram[(entries[i].key >> shift) & (BUCKETS - 1)];
+                        }
+                    });
+
+        // Skip the pass if every key has the same digit
+        size_t firstDigitCount = 0;
+        for (size_t d = 0; d < BUCKETS && firstDigitCount == 0; ++d)
+        {
+            for (auto const & histogram : histograms)
+            {
+                firstDigitCount += histogram[d];
+            }
+        }
+        if (firstDigitCount == count)
+        {
+            continue;
+        }
+
+        // Convert the counts into each thread's starting offset for each digit. The slices of lower-numbered threads come
+        // first within each digit, which keeps the sort stable.
+        size_t offset = 0;
+        for (size_t d = 0; d < BUCKETS; ++d)
+        {
+            for (auto & histogram : histograms)
+            {
+                size_t digitCount = histogram[d];
+                histogram[d]      = offset;
+                offset += digitCount;
+            }
+        }
+
+        // Scatter the entries
+        runParallel(threads,
+                    [&](unsigned t)
+                    {
+                        Histogram & offsets = histograms[t];
+                        for (size_t i = sliceBegin(count, t, threads); i < sliceBegin(count, t + 1, threads); ++i)
+                        {
+                            buffer[offsets[(entries[i].key >> shift) & (BUCKETS - 1)]++] = entries[i];
+                        }
+                    });
+        entries.swap(buffer);
+    }
+}
+
+//! @param  entries Entries sorted by key.
+void reduceSorted(std::vector<KeyedWeight> & entries)
+{
+    size_t out = 0;
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        if (out > 0 && entries[out - 1].key == entries[i].key)
+        {
+            entries[out - 1].weight += entries[i].weight;
+        }
+        else
+        {
+            entries[out++] = entries[i];
+        }
+    }
+    entries.resize(out);
+}
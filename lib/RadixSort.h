@@ -0,0 +1,20 @@
+#pragma once
+
+#include "NGramKey.h"
+
+#include <vector>
+
+//! Sorts entries by key using a parallel LSD radix sort.
+//!
+//! The sort is stable, so entries with equal keys keep their relative order and summing their weights after sorting gives
+//! the same result for any number of threads. Only the bits below the highest set bit of the largest key are sorted, and
+//! digits that are the same in every key are skipped.
+//!
+//! @param entries  Entries to sort.
+//! @param threads  Number of threads to use.
+void radixSort(std::vector<KeyedWeight> & entries, unsigned threads);
+
+//! Sums the weights of adjacent entries with equal keys, in place.
+//!
+//! @param entries  Entries sorted by key. On return, each key appears once.
+void reduceSorted(std::vector<KeyedWeight> & entries);
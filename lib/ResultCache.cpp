@@ -0,0 +1,171 @@
+#include "ResultCache.h"
+
+#include "NGramCounts.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+
+// Identifies the rules by which words are normalized and the format of the entries. Changing either invalidates the cache.
+uint32_t const CACHE_VERSION = 1;
+
+// Size of the blocks in which files are read, a multiple of 8
+size_t const READ_BLOCK_SIZE = size_t(1) << 20;
+
+uint64_t const PRIME_1 = 0x9e3779b97f4a7c15ull;
+uint64_t const PRIME_2 = 0xc2b2ae3d27d4eb4full;
+
+uint64_t rotateLeft(uint64_t x, unsigned bits)
+{
+    return (x << bits) | (x >> (64 - bits));
+}
+
+// Incremental hash of a byte sequence. Full eight-byte words are mixed as they arrive, and the remaining bytes and the
+// length are mixed by finish(), so the result does not depend on how the data is split across calls to add().
+class Hasher
+{
+public:
+    // Adds data. Every call but the last must add a multiple of 8 bytes.
+    void add(char const * data, size_t size)
+    {
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8)
+        {
+            uint64_t word;
+            std::memcpy(&word, data + i, 8);
+            state = (state ^ rotateLeft(word * PRIME_2, 31) * PRIME_1) * PRIME_1 + PRIME_2;
+        }
+        tail = 0;
+        if (i < size)
+        {
+            std::memcpy(&tail, data + i, size - i);
+        }
+        length += size;
+    }
+
+    uint64_t finish() const
+    {
+        // Mix the tail and the length, then avalanche the bits (the finalizer of MurmurHash3)
+        uint64_t h = (state ^ rotateLeft(tail * PRIME_2, 31) * PRIME_1) ^ (length * PRIME_2);
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 33;
+        return h;
+    }
+
+private:
+    uint64_t state  = PRIME_1;
+    uint64_t tail   = 0;
+    uint64_t length = 0;
+};
+
+// Returns a value as 16 hexadecimal digits
+std::string toHex(uint64_t value)
+{
+    static char const digits[] = "0123456789abcdef";
+    std::string       result(16, '0');
+    for (size_t i = 16; i-- > 0; value >>= 4)
+    {
+        result[i] = digits[value & 0xf];
+    }
+    return result;
+}
+
+} // anonymous namespace
+
+//! @param  data    The data.
+//!
+//! @return The fingerprint.
+uint64_t fingerprint(std::string_view data)
+{
+    Hasher hasher;
+    hasher.add(data.data(), data.size());
+    return hasher.finish();
+}
+
+//! @param  path    Path of the file.
+//!
+//! @return The fingerprint of the file's contents.
+//!
+//! @throws std::runtime_error if the file cannot be read.
+uint64_t fingerprintFile(std::string const & path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open())
+    {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+
+    // Every block but the last is full, so each is a multiple of 8 bytes as the hasher requires
+    Hasher            hasher;
+    std::vector<char> block(READ_BLOCK_SIZE);
+    while (in)
+    {
+        in.read(block.data(), static_cast<std::streamsize>(block.size()));
+        hasher.add(block.data(), static_cast<size_t>(in.gcount()));
+    }
+    if (in.bad())
+    {
+        throw std::runtime_error("Failed to read file: " + path);
+    }
+    return hasher.finish();
+}
+
+//! @param  directory   Directory of the entries.
+//! @param  inputPath   The input file.
+//! @param  options     Description of the options.
+//!
+//! @throws std::runtime_error if the input file cannot be read.
+ResultCache::ResultCache(std::string const & directory, std::string const & inputPath, std::string_view options)
+    : directory(directory)
+{
+    std::string key(options);
+    key += ";alphabet=";
+    key += VOWELS;
+    key += CONSONANTS;
+    key += ";version=" + std::to_string(CACHE_VERSION);
+    entryPath = (std::filesystem::path(directory) / (toHex(fingerprintFile(inputPath)) + "-" + toHex(fingerprint(key)) +
+                                                      ".ngc"))
+                    .string();
+}
+
+//! An entry that cannot be read is treated as missing, so that it is recomputed and replaced.
+//!
+//! @return The cached counting state, if any.
+std::optional<Checkpoint> ResultCache::load() const
+{
+    std::error_code error;
+    if (!std::filesystem::exists(entryPath, error))
+    {
+        return std::nullopt;
+    }
+    try
+    {
+        return Checkpoint::load(entryPath);
+    }
+    catch (std::exception const &)
+    {
+        return std::nullopt;
+    }
+}
+
+//! @param  state   The final counting state.
+//!
+//! @throws std::runtime_error if the entry cannot be written.
+void ResultCache::store(Checkpoint const & state) const
+{
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error)
+    {
+        throw std::runtime_error("Cannot create cache directory " + directory + ": " + error.message());
+    }
+    state.save(entryPath);
+}
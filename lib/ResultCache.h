@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Checkpoint.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+//! Returns a 64-bit fingerprint of some data.
+//!
+//! The data is hashed eight bytes at a time with multiply-rotate mixing, which runs at several gigabytes per second. The
+//! fingerprint is not cryptographic: it identifies unchanged data, it does not protect against deliberate collisions.
+uint64_t fingerprint(std::string_view data);
+
+//! Returns the fingerprint of the contents of a file, the same as fingerprint() of the contents.
+//!
+//! @throws std::runtime_error if the file cannot be read.
+uint64_t fingerprintFile(std::string const & path);
+
+//! Cache of counting results, stored in a directory and keyed by the input and the options.
+//!
+//! An entry is named after the fingerprint of the contents of the input file and the fingerprint of a description of the
+//! options that affect the results. The description also covers the normalized alphabet and a version of the normalization
+//! rules and of the entry format, so entries made by a different build are not reused. Entries hold the final counting
+//! state in the binary form of a Checkpoint, whose counts are stored as frozen tables, and they are written atomically.
+//!
+//! Example usage:
+//! @code
+//! ResultCache cache(".ngram-cache", inputPath, "SUBTLWF;min-weight=0");
+//! if (auto cached = cache.load())
+//!     state = std::move(*cached);
+//! else
+//!     cache.store(count(inputPath));
+//! @endcode
+class ResultCache
+{
+public:
+    //! Locates the entry of an input and a set of options.
+    //!
+    //! @param directory    Directory of the entries. It is created when the first entry is stored.
+    //! @param inputPath    The input file, which is read to compute its fingerprint.
+    //! @param options      Description of every option that affects the results.
+    //!
+    //! @throws std::runtime_error if the input file cannot be read.
+    ResultCache(std::string const & directory, std::string const & inputPath, std::string_view options);
+
+    //! Returns the path of the entry.
+    std::string const & path() const { return entryPath; }
+
+    //! Loads the entry, or returns nothing if there is no valid entry.
+    std::optional<Checkpoint> load() const;
+
+    //! Stores the final counting state as the entry, replacing any previous entry.
+    //!
+    //! @throws std::runtime_error if the entry cannot be written.
+    void store(Checkpoint const & state) const;
+
+private:
+    std::string directory; // Directory of the entries
+    std::string entryPath; // Path of the entry
+};
@@ -0,0 +1,193 @@
+// Two-pass thresholded counting engine
+//
+// When only the n-grams whose weight reaches a threshold are wanted, the first pass adds every n-gram to a Count-Min sketch,
+// and the second pass adds to the exact table only the n-grams whose sketch estimate reaches the threshold. A sketch
+// estimate is never less than the true weight, so every n-gram that reaches the threshold is counted exactly, while most
+// of the light n-grams never enter the exact table. Without a threshold, the first pass is skipped and every n-gram is
+// added to the exact table. N-grams are packed with the alphabet of the counting options.
+
+#include "NGramEngines.h"
+
+#include "Alphabet.h"
+#include "CountMinSketch.h"
+#include "NGramKey.h"
+#include "NGramTable.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+// Fingerprints of n-grams that cannot be packed have the top bit set, which only the keys of the longest n-grams of some
+// alphabets have. A fingerprint equal to a key only makes the estimates of both higher.
+uint64_t const UNPACKED_FINGERPRINT_BIT = uint64_t(1) << 63;
+
+// Relative slack of the sketch prefilter. A sketch estimate is summed in a different order than the exact weight, so an
+// estimate can round below an exact weight that reaches the threshold. The prefilter lets through the n-grams whose
+// estimate is within the slack of the threshold, and the exact pass drops those that do not reach it.
+double const PREFILTER_SLACK = 1e-6;
+
+// Calls onPacked(key, length) for every n-gram of a word that an alphabet can pack and onUnpacked(ngram) for every other
+// n-gram. An n-gram that can be packed is always identified by its key, even in a word that cannot be packed, so that its
+// weight is not split between two sketch items or two tables.
+template <typename PackedVisitor, typename UnpackedVisitor>
+void forEachNGram(std::string_view word, Alphabet const & alphabet, PackedVisitor && onPacked, UnpackedVisitor && onUnpacked)
+{
+    if (!alphabet.isPackable(word))
+    {
+        for (size_t n = 1; n <= word.size(); ++n)
+        {
+            for (size_t i = 0; i <= word.size() - n; ++i)
+            {
+                std::string    ngram = replaceSpecialSequences(word.substr(i, n));
+                NGramKey const key   = alphabet.pack(ngram);
+                if (key != 0)
+                {
+                    onPacked(key, ngram.size());
+                }
+                else
+                {
+                    onUnpacked(ngram);
+                }
+            }
+        }
+        return;
+    }
+    alphabet.forEachNormalizedNGram(word,
+                                    [&](NGramKey key, size_t length, size_t start, size_t rawLength)
+                                    {
+                                        if (key != 0)
+                                        {
+                                            onPacked(key, length);
+                                        }
+                                        else
+                                        {
+                                            onUnpacked(replaceSpecialSequences(word.substr(start, rawLength)));
+                                        }
+                                    });
+}
+
+uint64_t unpackedFingerprint(std::string const & ngram)
+{
+    return std::hash<std::string>{}(ngram) | UNPACKED_FINGERPRINT_BIT;
+}
+
+} // anonymous namespace
+
+//! @param  counts      Counts to add to.
+//! @param  words       The words and their weights.
+//! @param  begin       Index of the first word to count.
+//! @param  end         Index past the last word to count.
+//! @param  threads     Number of threads to use.
+//! @param  minWeight   N-grams with less weight are not counted. 0 counts every n-gram.
+//! @param  alphabet    Symbols the n-grams are packed with.
+void countWithSketchEngine(NGramCounts &    counts,
+                           WordList const & words,
+                           size_t           begin,
+                           size_t           end,
+                           unsigned         threads,
+                           double           minWeight,
+                           Alphabet const & alphabet)
+{
+    size_t const count         = end - begin;
+    size_t       maxWordLength = 0;
+    size_t       totalNGrams   = 0;   // Number of n-grams, counting each occurrence
+    double       totalWeight   = 0.0; // Total weight of all n-grams
+    for (size_t w = begin; w < end; ++w)
+    {
+        size_t length = words[w].first.size();
+        maxWordLength = std::max(maxWordLength, length);
+        totalNGrams += length * (length + 1) / 2;
+        totalWeight += words[w].second * static_cast<double>(length * (length + 1) / 2);
+    }
+    if (count == 0)
+    {
+        return;
+    }
+    counts.extend(maxWordLength);
+
+    // Pass 1: sketch the weights of all n-grams. Each thread enumerates the n-grams of its slice of the words once and adds
+    // them to a single sketch shared by every thread, so the memory of the sketch does not grow with the number of threads.
+    // A single thread adds without the atomic read-modify-write that concurrent adds need.
+    bool const     prefilter   = minWeight > 0.0;
+    double const   minEstimate = minWeight * (1.0 - PREFILTER_SLACK);
+    size_t const   width       = prefilter ? CountMinSketch::widthFor(totalWeight, minWeight, totalNGrams) : 1;
+    CountMinSketch sketch(width, SKETCH_DEPTH);
+    if (prefilter)
+    {
+        runParallel(threads,
+                    [&](unsigned t)
+                    {
+                        for (size_t w = sliceBegin(count, t, threads); w < sliceBegin(count, t + 1, threads); ++w)
+                        {
+                            auto const & [word, weight] = words[begin + w];
+                            auto const add              = [&](uint64_t fingerprint)
+                            {
+                                if (threads > 1)
+                                {
+                                    sketch.addConcurrently(fingerprint, weight);
+                                }
+                                else
+                                {
+                                    sketch.add(fingerprint, weight);
+                                }
+                            };
+                            forEachNGram(
+                                word,
+                                alphabet,
+                                [&](NGramKey key, size_t) { add(key); },
+                                [&](std::string const & ngram) { add(unpackedFingerprint(ngram)); });
+                        }
+                    });
+    }
+
+    // Pass 2: count the n-grams whose estimated weight reaches the threshold exactly. Every n-gram contributes to the
+    // total weights.
+    std::vector<NGramTable>  tables(threads);
+    std::vector<NGramCounts> unpacked(threads);
+    runParallel(threads,
+                [&](unsigned t)
+                {
+                    NGramTable &  table  = tables[t];
+                    NGramCounts & others = unpacked[t];
+                    others.extend(maxWordLength);
+                    for (size_t w = sliceBegin(count, t, threads); w < sliceBegin(count, t + 1, threads); ++w)
+                    {
+                        auto const & [word, weight] = words[begin + w];
+                        forEachNGram(
+                            word,
+                            alphabet,
+                            [&](NGramKey key, size_t length)
+                            {
+                                others.totalWeights[length] += weight;
+                                if (!prefilter || sketch.estimate(key) >= minEstimate)
+                                {
+                                    table.add(key, weight);
+                                }
+                            },
+                            [&](std::string const & ngram)
+                            {
+                                others.totalWeights[ngram.size()] += weight;
+                                if (!prefilter || sketch.estimate(unpackedFingerprint(ngram)) >= minEstimate)
+                                {
+                                    others.ngramMaps[ngram.size()][ngram] += weight;
+                                }
+                            });
+                    }
+                });
+
+    // Merge the threads' results in order, and drop the n-grams that passed the sketch but not the threshold
+    for (unsigned t = 1; t < threads; ++t)
+    {
+        tables[0].merge(tables[t]);
+        unpacked[0].merge(unpacked[t]);
+    }
+    NGramCounts result = std::move(unpacked[0]);
+    tables[0].addTo(result, alphabet);
+    result.prune(minWeight);
+    counts.merge(result);
+}
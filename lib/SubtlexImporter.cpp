@@ -61,13 +61,10 @@ std::unordered_map<std::string_view, ColumnType> const columnTypes = {{"Word", C
 std::vector<std::string> splitCSVLine(std::string_view line);
 void                     validateColumnNames(std::vector<std::string> const & names);
 
-} // anonymous namespace
-
-//! @param  path    Path to the CSV file to import.
-//!
-//! @throws std::runtime_error if the file cannot be opened, parsed, or if the columns are invalid (missing, unexpected, or
-//!         duplicated), or if there are duplicate words in the data.
-SubtlexImporter::SubtlexImporter(std::string_view path)
+// Reads and validates a CSV file. Calls onHeader(columnNames) once the header has been validated, and then onRow(rawRow) for
+// each row, after its word has been converted to lowercase and checked.
+template <typename HeaderHandler, typename RowHandler>
+void readRows(std::string_view path, HeaderHandler && onHeader, RowHandler && onRow)
 {
     // Open the file
     std::ifstream input{std::string(path)};
@@ -86,15 +83,10 @@ SubtlexImporter::SubtlexImporter(std::string_view path)
 
     // Validate columns
     validateColumnNames(columnNames);
-
-    // Map column names to their indices. The order of names in columnNames determines the index.
-    for (size_t i = 0; i < columnNames.size(); ++i)
-    {
-        columnIndices[columnNames[i]] = i;
-    }
+    onHeader(columnNames);
 
     // Find the index of the Word column for duplicate checking
-    size_t wordIdx = columnIndices.at("Word");
+    size_t wordIdx = std::find(columnNames.begin(), columnNames.end(), "Word") - columnNames.begin();
 
     // Track words we've seen to detect duplicates
     std::unordered_set<std::string> seenWords;
@@ -130,17 +122,43 @@ SubtlexImporter::SubtlexImporter(std::string_view path)
         }
         seenWords.insert(word);
 
-        // Parse each value in the row according to its column type
-        std::vector<Value> typedRow;
-        typedRow.reserve(rawRow.size());
-        for (size_t i = 0; i < rawRow.size(); ++i)
+        onRow(rawRow);
+    }
+}
+
+} // anonymous namespace
+
+//! @param  path    Path to the CSV file to import.
+//!
+//! @throws std::runtime_error if the file cannot be opened, parsed, or if the columns are invalid (missing, unexpected, or
+//!         duplicated), or if there are duplicate words in the data.
+SubtlexImporter::SubtlexImporter(std::string_view path)
+{
+    std::vector<std::string> columnNames;
+    readRows(
+        path,
+        [&](std::vector<std::string> const & names)
         {
-            typedRow.push_back(parseValue(rawRow[i], columnNames[i]));
-        }
+            // Map column names to their indices. The order of names in columnNames determines the index.
+            columnNames = names;
+            for (size_t i = 0; i < columnNames.size(); ++i)
+            {
+                columnIndices[columnNames[i]] = i;
+            }
+        },
+        [&](std::vector<std::string> const & rawRow)
+        {
+            // Parse each value in the row according to its column type
+            std::vector<Value> typedRow;
+            typedRow.reserve(rawRow.size());
+            for (size_t i = 0; i < rawRow.size(); ++i)
+            {
+                typedRow.push_back(parseValue(rawRow[i], columnNames[i]));
+            }
 
-        // Store the row in the table
-        table.emplace_back(std::move(typedRow));
-    }
+            // Store the row in the table
+            table.emplace_back(std::move(typedRow));
+        });
 }
 
 //! @param  columnName  Name of the column to retrieve values for.
@@ -168,7 +186,43 @@ std::unordered_map<std::string, SubtlexImporter::Value> SubtlexImporter::get(std
     return result;
 }
 
-SubtlexImporter::Value SubtlexImporter::parseValue(std::string_view value, std::string_view columnName) const
+//! @param  path        Path to the CSV file to read.
+//! @param  columnName  Name of the column whose values are visited.
+//! @param  visit       Called with the word and the value of the column in each row.
+//!
+//! @throws std::runtime_error if the file cannot be opened, parsed, or if the columns are invalid (missing, unexpected, or
+//!         duplicated), or if there are duplicate words in the data.
+void SubtlexImporter::forEach(std::string_view                                                   path,
+                              std::string_view                                                   columnName,
+                              std::function<void(std::string const & word, Value const & value)> visit)
+{
+    size_t wordIdx = 0;
+    size_t colIdx  = 0;
+    bool   valid   = false;
+    readRows(
+        path,
+        [&](std::vector<std::string> const & names)
+        {
+            for (size_t i = 0; i < names.size(); ++i)
+            {
+                wordIdx = (names[i] == "Word") ? i : wordIdx;
+                if (names[i] == columnName)
+                {
+                    colIdx = i;
+                    valid  = true;
+                }
+            }
+        },
+        [&](std::vector<std::string> const & rawRow)
+        {
+            if (valid)
+            {
+                visit(rawRow[wordIdx], parseValue(rawRow[colIdx], columnName));
+            }
+        });
+}
+
+SubtlexImporter::Value SubtlexImporter::parseValue(std::string_view value, std::string_view columnName)
 {
     auto it = columnTypes.find(columnName);
     if (it == columnTypes.end())
@@ -2,6 +2,7 @@
 
 #include "DatasetImporter.h"
 
+#include <functional>
 #include <string>
 #include <string_view>
 #include <unordered_map>
@@ -30,8 +31,20 @@ public:
     //! Returns the value for each word in the specified column.
     std::unordered_map<std::string, Value> get(std::string_view columnName) const override;
 
+    //! Reads a CSV file one row at a time and calls visit(word, value) with the value of the specified column in each row.
+    //!
+    //! The file is validated as by the constructor, but it is not stored, so the rows can be processed while the file is
+    //! still being read. Rows before an invalid row have already been visited when the error is detected.
+    //!
+    //! @param path         Path to the CSV file to read.
+    //! @param columnName   Name of the column whose values are visited. No rows are visited if the name is invalid.
+    //! @param visit        Called for each row, in file order.
+    static void forEach(std::string_view                                                   path,
+                        std::string_view                                                   columnName,
+                        std::function<void(std::string const & word, Value const & value)> visit);
+
 private:
-    Value parseValue(std::string_view value, std::string_view columnName) const;
+    static Value parseValue(std::string_view value, std::string_view columnName);
 
     std::unordered_map<std::string, size_t> columnIndices; // Maps column names (views into columnNames) to their indices
     std::vector<std::vector<Value>>         table;         // Table of parsed CSV data
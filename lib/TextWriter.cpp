@@ -0,0 +1,20 @@
+#include "TextWriter.h"
+
+namespace
+{
+
+// Number of significant digits of a double, as a std::ostream writes it by default
+int const DOUBLE_PRECISION = 6;
+
+} // anonymous namespace
+
+//! @param  x   The double.
+//! @return     The writer.
+TextWriter & TextWriter::operator<<(double x)
+{
+    // "-d.ddddde-308" is the longest text
+    char chars[32];
+    char const * end = std::to_chars(chars, chars + sizeof(chars), x, std::chars_format::general, DOUBLE_PRECISION).ptr;
+    output.append(std::string_view(chars, end - chars));
+    return *this;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "OutputBuffer.h"
+
+#include <charconv>
+#include <cstddef>
+#include <limits>
+#include <ostream>
+#include <string_view>
+#include <type_traits>
+
+//! Writes text and numbers to a stream through an OutputBuffer, formatted as a std::ostream with default flags formats
+//! them.
+//!
+//! Numbers are formatted with std::to_chars instead of the locale-aware iostream machinery: integers in decimal, and
+//! doubles with 6 significant digits in the shorter of fixed and scientific notation, as "%g" formats them. The output is
+//! written to the stream in large blocks, so it may be held back until flush() is called or the writer is destroyed.
+class TextWriter
+{
+public:
+    //! Constructs a writer that writes to a stream.
+    explicit TextWriter(std::ostream & out, size_t bufferSize = OUTPUT_BUFFER_SIZE)
+        : output(out, bufferSize)
+    {
+    }
+
+    //! Writes text.
+    TextWriter & operator<<(std::string_view text)
+    {
+        output.append(text);
+        return *this;
+    }
+
+    //! Writes a character.
+    TextWriter & operator<<(char c)
+    {
+        output.append(c);
+        return *this;
+    }
+
+    //! Writes a double as "%g" formats it.
+    TextWriter & operator<<(double x);
+
+    //! Writes an integer in decimal.
+    template <typename T, typename = std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, char> &&
+                                                  !std::is_same_v<T, bool>>>
+    TextWriter & operator<<(T x)
+    {
+        char chars[std::numeric_limits<T>::digits10 + 3];
+        output.append(std::string_view(chars, std::to_chars(chars, chars + sizeof(chars), x).ptr - chars));
+        return *this;
+    }
+
+    //! Writes the buffered output to the stream.
+    void flush() { output.flush(); }
+
+private:
+    OutputBuffer output; // The buffered output
+};
@@ -0,0 +1,31 @@
+#include "WordArena.h"
+
+WordArena::WordArena()
+    : starts{0}
+{
+}
+
+//! @param  words   The words to store. Their weights are ignored.
+WordArena::WordArena(WordList const & words)
+    : WordArena()
+{
+    size_t bytes = 0;
+    for (auto const & entry : words)
+    {
+        bytes += entry.first.size() + 1;
+    }
+    text.reserve(bytes);
+    starts.reserve(words.size() + 1);
+    for (auto const & entry : words)
+    {
+        add(entry.first);
+    }
+}
+
+//! @param  word    The word to add. It must not contain '\0'.
+void WordArena::add(std::string_view word)
+{
+    text.append(word);
+    text.push_back('\0');
+    starts.push_back(text.size());
+}
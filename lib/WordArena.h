@@ -0,0 +1,41 @@
+#pragma once
+
+#include "NGramCounts.h"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//! A list of words stored back to back in a single buffer.
+//!
+//! Each word is followed by a '\0' separator, so a word must not contain '\0'. Storing the words contiguously lets threads
+//! that scan the whole list read it as one stream of bytes.
+class WordArena
+{
+public:
+    //! Constructs an empty arena.
+    WordArena();
+
+    //! Constructs an arena containing the words of a word list, in order.
+    explicit WordArena(WordList const & words);
+
+    //! Appends a word.
+    void add(std::string_view word);
+
+    //! Returns the number of words.
+    size_t size() const { return starts.size() - 1; }
+
+    //! Returns a word.
+    std::string_view operator[](size_t i) const
+    {
+        return std::string_view(text).substr(starts[i], starts[i + 1] - starts[i] - 1);
+    }
+
+    //! Returns the words and their separators.
+    std::string const & bytes() const { return text; }
+
+private:
+    std::string         text;   // The words, each followed by '\0'
+    std::vector<size_t> starts; // Offset of each word in text, followed by the size of text
+};
@@ -0,0 +1,99 @@
+#include "WordSchedule.h"
+
+#include "NGramKey.h"
+
+//! Each replaced "qu" is one symbol, and every other character is one symbol.
+//!
+//! @param  word    The word.
+//!
+//! @return The normalized length of the word.
+size_t normalizedLength(std::string_view word)
+{
+    using namespace NGramKeyDetail;
+
+    size_t length = 0;
+    size_t p      = 0;
+    while (p < word.size())
+    {
+        char const c0 = word[p];
+        char const c1 = (p + 1 < word.size()) ? word[p + 1] : '\0';
+        if ((c1 == 'y' && precedesVowelY(c0)) || (c1 == 'w' && precedesVowelW(c0)))
+        {
+            length += 2;
+            p += 2;
+        }
+        else if (c0 == 'q' && c1 == 'u')
+        {
+            length += 1;
+            p += 2;
+        }
+        else
+        {
+            length += 1;
+            p += 1;
+        }
+    }
+    return length;
+}
+
+//! The words are bucketed with a stable counting sort on their normalized lengths.
+//!
+//! @param  words           The words and their weights.
+//! @param  begin           Index of the first word to schedule.
+//! @param  end             Index past the last word to schedule.
+//! @param  blockCharacters Maximum number of characters in a block.
+//!
+//! @return The schedule of words[begin, end).
+WordSchedule scheduleWords(WordList const & words, size_t begin, size_t end, size_t blockCharacters)
+{
+    WordSchedule schedule;
+    if (end <= begin)
+    {
+        return schedule;
+    }
+
+    // Count the words of each normalized length
+    std::vector<size_t> lengths(end - begin);
+    std::vector<size_t> bucketStarts;
+    for (size_t w = begin; w < end; ++w)
+    {
+        size_t const length = normalizedLength(words[w].first);
+        lengths[w - begin]  = length;
+        if (bucketStarts.size() < length + 2)
+        {
+            bucketStarts.resize(length + 2, 0);
+        }
+        ++bucketStarts[length + 1];
+    }
+    for (size_t length = 1; length < bucketStarts.size(); ++length)
+    {
+        bucketStarts[length] += bucketStarts[length - 1];
+    }
+
+    // Place each word in its bucket, in range order
+    schedule.order.resize(end - begin);
+    std::vector<size_t> next(bucketStarts.begin(), bucketStarts.end() - 1);
+    for (size_t w = begin; w < end; ++w)
+    {
+        schedule.order[next[lengths[w - begin]]++] = w;
+    }
+
+    // Split each bucket into blocks
+    for (size_t length = 0; length + 1 < bucketStarts.size(); ++length)
+    {
+        size_t i = bucketStarts[length];
+        while (i < bucketStarts[length + 1])
+        {
+            size_t const blockBegin = i;
+            size_t       characters = 0;
+            do
+            {
+                characters += words[schedule.order[i]].first.size();
+                ++i;
+            } while (i < bucketStarts[length + 1] &&
+                     characters + words[schedule.order[i]].first.size() <= blockCharacters);
+            schedule.blocks.push_back({blockBegin, i, length});
+        }
+    }
+    return schedule;
+}
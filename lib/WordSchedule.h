@@ -0,0 +1,47 @@
+#pragma once
+
+#include "NGramCounts.h"
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+//! Default maximum number of characters in a block of a WordSchedule.
+inline constexpr size_t WORD_BLOCK_CHARACTERS = 16384;
+
+//! A block of words of a WordSchedule, all of the same normalized length.
+struct WordBlock
+{
+    size_t begin;  //!< Index in WordSchedule::order of the first word of the block
+    size_t end;    //!< Index in WordSchedule::order past the last word of the block
+    size_t length; //!< Normalized length of the words
+};
+
+//! Order in which a range of words is counted.
+//!
+//! The words are bucketed by normalized length, shortest first, and each bucket is split into blocks of consecutive words
+//! with few enough characters that the n-grams of one length of a whole block can be counted while the block stays in cache.
+//! Counting a block one n-gram length at a time then updates a single length's table for many words in a row, instead of
+//! every length's table for each word. Within a bucket, the words keep their order in the range, so the schedule of a range
+//! is deterministic.
+struct WordSchedule
+{
+    std::vector<size_t>    order;  //!< Index in the word list of each word, in the order they are counted
+    std::vector<WordBlock> blocks; //!< The blocks, in order
+};
+
+//! Returns the length of a word after it is normalized by replaceSpecialSequences(), without building the normalized word.
+size_t normalizedLength(std::string_view word);
+
+//! Schedules a range of words.
+//!
+//! @param  words           The words and their weights.
+//! @param  begin           Index of the first word to schedule.
+//! @param  end             Index past the last word to schedule.
+//! @param  blockCharacters Maximum number of characters in a block. A block always holds at least one word.
+//!
+//! @return The schedule of words[begin, end).
+WordSchedule scheduleWords(WordList const & words,
+                           size_t           begin,
+                           size_t           end,
+                           size_t           blockCharacters = WORD_BLOCK_CHARACTERS);
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <NGramCounts.h>
+
+#include <cstddef>
+#include <random>
+#include <string>
+#include <string_view>
+
+//! Number of different weights of the words returned by randomWords()
+inline constexpr unsigned RANDOM_WEIGHT_STEPS = 40;
+
+//! Returns random words and weights. The same arguments always return the same words.
+//!
+//! @param seed         Seed of the random number generator.
+//! @param count        Number of words.
+//! @param letters      Letters of the words. A letter that appears several times is drawn more often.
+//! @param maxLength    Each word has 1 to maxLength letters.
+//! @param weightStep   Each weight is 1 to RANDOM_WEIGHT_STEPS times this step.
+//! @param rareLetters  Letters that only every seventh word may also contain, such as characters outside the alphabet.
+//!
+//! @return The words and their weights.
+inline WordList randomWords(unsigned         seed,
+                            size_t           count,
+                            std::string_view letters,
+                            size_t           maxLength,
+                            double           weightStep,
+                            std::string_view rareLetters = "")
+{
+    std::string const allLetters = std::string(letters) + std::string(rareLetters);
+    std::mt19937      rng(seed);
+    WordList          words(count);
+    for (size_t w = 0; w < count; ++w)
+    {
+        auto & [word, weight]          = words[w];
+        std::string_view const choices = (w % 7 == 0) ? std::string_view(allLetters) : letters;
+        word.resize(1 + rng() % maxLength, ' ');
+        for (auto & c : word)
+        {
+            c = choices[rng() % choices.size()];
+        }
+        weight = weightStep * (1 + rng() % RANDOM_WEIGHT_STEPS);
+    }
+    return words;
+}
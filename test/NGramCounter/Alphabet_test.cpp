@@ -0,0 +1,189 @@
+#include <Alphabet.h>
+#include <DocumentFrequency.h>
+#include <NGramCounter.h>
+#include <NGramCounts.h>
+#include <NGramKey.h>
+#include <RandomWords.h>
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+// Writes a file and returns its path
+std::string writeFile(std::string const & name, std::string const & contents)
+{
+    std::string const path = (fs::temp_directory_path() / name).string();
+    std::ofstream(path) << contents;
+    return path;
+}
+
+} // anonymous namespace
+
+// ========== Alphabet Tests ==========
+
+TEST(AlphabetTest, EnglishPacksLikePackNGram)
+{
+    Alphabet const & english = Alphabet::english();
+    EXPECT_EQ(english.size(), VOWELS.size() + CONSONANTS.size());
+    EXPECT_EQ(english.symbolBits(), NGRAM_KEY_SYMBOL_BITS);
+    EXPECT_EQ(english.maxPackedLength(), MAX_PACKED_NGRAM_LENGTH);
+    EXPECT_EQ(english.symbolsOf(SymbolClass::Vowel), VOWELS);
+    EXPECT_EQ(english.symbolsOf(SymbolClass::Consonant), CONSONANTS);
+    for (std::string ngram : {"e", "the", "Qeen", "plaY", "abcdefghijkl", "abcdefghijklm", "don't", ""})
+    {
+        EXPECT_EQ(english.pack(ngram), packNGram(ngram)) << ngram;
+        if (packNGram(ngram) != 0)
+        {
+            EXPECT_EQ(english.unpack(english.pack(ngram)), ngram);
+            EXPECT_EQ(english.packedLength(english.pack(ngram)), ngram.size());
+        }
+    }
+}
+
+TEST(AlphabetTest, SmallAlphabetUsesFewerBits)
+{
+    // 5 symbols need codes 1 to 5, so 3 bits, and 21 symbols fit in a key
+    Alphabet alphabet("ae", "bcd");
+    EXPECT_EQ(alphabet.symbolBits(), 3u);
+    EXPECT_EQ(alphabet.maxPackedLength(), 21u);
+    EXPECT_EQ(alphabet.code('a'), 1u);
+    EXPECT_EQ(alphabet.code('d'), 5u);
+    EXPECT_EQ(alphabet.code('x'), 0u);
+    EXPECT_EQ(alphabet.symbolClass('e'), SymbolClass::Vowel);
+    EXPECT_EQ(alphabet.symbolClass('b'), SymbolClass::Consonant);
+    EXPECT_EQ(alphabet.symbolClass('x'), SymbolClass::Other);
+
+    std::string const ngram = "abcdeabcdeabcdeabcdea";
+    EXPECT_EQ(alphabet.unpack(alphabet.pack(ngram)), ngram);
+    EXPECT_EQ(alphabet.pack(ngram + "b"), 0u);
+    EXPECT_EQ(alphabet.pack("ax"), 0u);
+
+    EXPECT_THROW(Alphabet("ae", "ba"), std::invalid_argument);
+    EXPECT_THROW(Alphabet("", ""), std::invalid_argument);
+}
+
+TEST(AlphabetTest, IsPackableChecksReplacedSymbols)
+{
+    // Without 'Q', a word containing "qu" cannot be packed, but one with a 'q' or a 'u' alone can
+    Alphabet alphabet("aeiouYW", "qtnh");
+    EXPECT_FALSE(alphabet.isPackable("quit"));
+    EXPECT_TRUE(alphabet.isPackable("qat"));
+    EXPECT_TRUE(alphabet.isPackable("hut"));
+    EXPECT_FALSE(alphabet.isPackable("hex"));
+    EXPECT_TRUE(Alphabet::english().isPackable("quit"));
+}
+
+TEST(AlphabetTest, LoadReadsClassesFromAFile)
+{
+    std::string const path = writeFile("test_alphabet.txt", "# Vowels first\nvowel aeiou\n\nconsonant tnsr\nother '\nvowel y\n");
+    Alphabet const    alphabet = Alphabet::load(path);
+    EXPECT_EQ(alphabet.symbolsOf(SymbolClass::Vowel), "aeiouy");
+    EXPECT_EQ(alphabet.symbolsOf(SymbolClass::Consonant), "tnsr");
+    EXPECT_EQ(alphabet.symbolsOf(SymbolClass::Other), "'");
+    EXPECT_EQ(alphabet.symbolBits(), 4u);
+
+    EXPECT_THROW(Alphabet::load(writeFile("test_alphabet_label.txt", "letter abc\n")), std::runtime_error);
+    EXPECT_THROW(Alphabet::load(writeFile("test_alphabet_duplicate.txt", "vowel a\nconsonant a\n")), std::runtime_error);
+    EXPECT_THROW(Alphabet::load(writeFile("test_alphabet_fields.txt", "vowel a e\n")), std::runtime_error);
+    EXPECT_THROW(Alphabet::load((fs::temp_directory_path() / "no_such_alphabet.txt").string()), std::runtime_error);
+}
+
+TEST(AlphabetTest, FromWordsAddsOtherCharacters)
+{
+    WordList const words    = {{"don't", 1.0}, {"r2d2", 1.0}, {"the", 1.0}};
+    Alphabet const alphabet = Alphabet::fromWords(words);
+    EXPECT_EQ(alphabet.size(), Alphabet::english().size() + 2);
+    EXPECT_EQ(alphabet.symbolsOf(SymbolClass::Other), "'2");
+    EXPECT_TRUE(alphabet.isPackable("don't"));
+    EXPECT_EQ(alphabet.unpack(alphabet.pack("n't")), "n't");
+}
+
+TEST(AlphabetTest, EnginesCountWithAnyAlphabet)
+{
+    // Words with characters outside the English alphabet, and long n-grams that a small alphabet packs
+    WordList const words = randomWords(1, 2000, "abqu'ywe", 20, 0.5);
+
+    NGramCounts expected;
+    for (auto const & [word, weight] : words)
+    {
+        expected.addWord(word, weight);
+    }
+
+    Alphabet const small("aeuYW", "bqQ", "y'");
+    for (CountingEngine engine : {CountingEngine::Radix, CountingEngine::Sketch, CountingEngine::Levelwise})
+    {
+        for (double minWeight : {0.0, 40.0})
+        {
+            NGramCounts thresholded = expected;
+            thresholded.prune(minWeight);
+            for (Alphabet const * alphabet : {&Alphabet::english(), &small})
+            {
+                for (unsigned threads : {1u, 3u})
+                {
+                    CountingOptions options;
+                    options.engine    = engine;
+                    options.threads   = threads;
+                    options.minWeight = minWeight;
+                    options.alphabet  = alphabet;
+                    NGramCounts counts;
+                    countNGrams(counts, words, 0, words.size(), options);
+                    EXPECT_EQ(counts.ngramMaps, thresholded.ngramMaps)
+                        << countingEngineName(engine) << ", min weight " << minWeight << ", " << alphabet->size()
+                        << " symbols, " << threads << " threads";
+                    EXPECT_EQ(counts.totalWeights, expected.totalWeights);
+                }
+            }
+        }
+    }
+}
+
+TEST(AlphabetTest, DocumentFrequenciesWithAnyAlphabet)
+{
+    WordList const words = randomWords(2, 1000, "abqu'ywe", 20, 0.5);
+
+    CountingOptions                   options;
+    NGramCounts                       expected;
+    std::vector<DocumentFrequencyMap> expectedFrequencies;
+    countDocumentFrequencies(expected, expectedFrequencies, words, 0, words.size(), options);
+
+    Alphabet const small("aeuYW", "bqQ", "y'");
+    options.alphabet = &small;
+    options.threads  = 3;
+    NGramCounts                       counts;
+    std::vector<DocumentFrequencyMap> frequencies;
+    countDocumentFrequencies(counts, frequencies, words, 0, words.size(), options);
+    EXPECT_EQ(counts.ngramMaps, expected.ngramMaps);
+    EXPECT_EQ(counts.totalWeights, expected.totalWeights);
+    ASSERT_EQ(frequencies.size(), expectedFrequencies.size());
+    for (size_t n = 0; n < frequencies.size(); ++n)
+    {
+        ASSERT_EQ(frequencies[n].size(), expectedFrequencies[n].size()) << n;
+        for (auto const & [ngram, frequency] : expectedFrequencies[n])
+        {
+            EXPECT_EQ(frequencies[n].at(ngram).words, frequency.words) << ngram;
+            EXPECT_EQ(frequencies[n].at(ngram).weight, frequency.weight) << ngram;
+        }
+    }
+}
+
+TEST(AlphabetTest, ExtractsNGramsByClass)
+{
+    NGramCounts counts;
+    counts.addWord("ab'a", 1.0);
+    Alphabet const alphabet("b", "a'");
+
+    VowelConsonantNGrams classes = extractVowelConsonantNGrams(counts, alphabet);
+    EXPECT_EQ(classes.vowels.size(), 1u);
+    EXPECT_EQ(classes.vowels.count("b"), 1u);
+    EXPECT_EQ(classes.consonants.count("'a"), 1u);
+    EXPECT_EQ(classes.consonants.count("ab"), 0u);
+    EXPECT_DOUBLE_EQ(classes.totalConsonants, 2.0 + 1.0 + 1.0);
+}
@@ -0,0 +1,120 @@
+#include <BinaryWriter.h>
+#include <JsonWriter.h>
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+// Writes the same document as document() with a writer
+template <typename Writer>
+void writeDocument(Writer & writer)
+{
+    std::vector<uint64_t> const integers = {0, 23, 24, 127, 128, 255, 256, 65535, 65536, (1ull << 32) - 1, 1ull << 32};
+    std::vector<double> const   doubles  = {0.0, 1.5, -2.0, 0.1, 1e300, std::numeric_limits<double>::infinity(), std::nan("")};
+    std::vector<size_t> const   lengths  = {0, 23, 24, 31, 32, 255, 256, 65535, 65536};
+
+    writer.beginObject(4);
+    writer.key("doubles");
+    writer.beginArray(doubles.size());
+    for (double x : doubles)
+    {
+        writer.value(x);
+    }
+    writer.endArray();
+    writer.key("integers");
+    writer.beginArray(integers.size());
+    for (uint64_t x : integers)
+    {
+        writer.value(x);
+    }
+    writer.endArray();
+    writer.key("maps");
+    writer.beginArray(3);
+    for (size_t size : {0u, 15u, 70000u})
+    {
+        std::map<std::string, double> map;
+        for (size_t i = 0; i < size; ++i)
+        {
+            map[std::to_string(i)] = static_cast<double>(i) / 4.0;
+        }
+        writeSortedObject(writer, map, [](Writer & w, double x) { w.value(x); });
+    }
+    writer.endArray();
+    writer.key("strings");
+    writer.beginArray(lengths.size());
+    for (size_t length : lengths)
+    {
+        writer.value(std::string(length, 'a'));
+    }
+    writer.endArray();
+    writer.endObject();
+}
+
+// The document written by writeDocument()
+nlohmann::json document()
+{
+    nlohmann::json j;
+    j["doubles"]  = {0.0, 1.5, -2.0, 0.1, 1e300, std::numeric_limits<double>::infinity(), std::nan("")};
+    j["integers"] = std::vector<uint64_t>{0, 23, 24, 127, 128, 255, 256, 65535, 65536, (1ull << 32) - 1, 1ull << 32};
+    j["maps"]     = nlohmann::json::array();
+    for (size_t size : {0u, 15u, 70000u})
+    {
+        nlohmann::json map = nlohmann::json::object();
+        for (size_t i = 0; i < size; ++i)
+        {
+            map[std::to_string(i)] = static_cast<double>(i) / 4.0;
+        }
+        j["maps"].push_back(map);
+    }
+    j["strings"] = nlohmann::json::array();
+    for (size_t length : {0u, 23u, 24u, 31u, 32u, 255u, 256u, 65535u, 65536u})
+    {
+        j["strings"].push_back(std::string(length, 'a'));
+    }
+    return j;
+}
+
+// Writes the document in a format
+std::vector<uint8_t> writeBinary(BinaryFormat format)
+{
+    std::ostringstream out;
+    {
+        BinaryWriter writer(out, format, 1000);
+        writeDocument(writer);
+    }
+    std::string const bytes = out.str();
+    return std::vector<uint8_t>(bytes.begin(), bytes.end());
+}
+
+} // anonymous namespace
+
+// ========== BinaryWriter Tests ==========
+
+TEST(BinaryWriterTest, CborMatchesNlohmann)
+{
+    EXPECT_EQ(writeBinary(BinaryFormat::Cbor), nlohmann::json::to_cbor(document()));
+}
+
+TEST(BinaryWriterTest, MessagePackMatchesNlohmann)
+{
+    EXPECT_EQ(writeBinary(BinaryFormat::MessagePack), nlohmann::json::to_msgpack(document()));
+}
+
+TEST(BinaryWriterTest, JsonWriterWritesTheSameDocument)
+{
+    std::ostringstream out;
+    {
+        JsonWriter writer(out);
+        writeDocument(writer);
+    }
+    EXPECT_EQ(out.str(), document().dump(2));
+}
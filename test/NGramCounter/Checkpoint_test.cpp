@@ -0,0 +1,68 @@
+#include <Checkpoint.h>
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace fs = std::filesystem;
+
+// Test fixture providing a checkpoint path that is removed after each test
+class CheckpointTest : public ::testing::Test
+{
+protected:
+    void SetUp() override { path = (fs::temp_directory_path() / "test_checkpoint.ckpt").string(); }
+
+    void TearDown() override
+    {
+        fs::remove(path);
+        fs::remove(path + ".tmp");
+    }
+
+    std::string path;
+};
+
+TEST_F(CheckpointTest, SaveLoadRoundTrip)
+{
+    Checkpoint checkpoint;
+    checkpoint.counts.addWord("checkpoint", 3.5);
+    checkpoint.position        = 42;
+    checkpoint.processedWeight = 3.5;
+    checkpoint.inputWords      = 100;
+    checkpoint.inputWeight     = 1234.5;
+    checkpoint.save(path);
+
+    Checkpoint loaded = Checkpoint::load(path);
+    EXPECT_EQ(loaded.position, 42);
+    EXPECT_DOUBLE_EQ(loaded.processedWeight, 3.5);
+    EXPECT_EQ(loaded.inputWords, 100);
+    EXPECT_DOUBLE_EQ(loaded.inputWeight, 1234.5);
+    EXPECT_EQ(loaded.counts.ngramMaps, checkpoint.counts.ngramMaps);
+    EXPECT_EQ(loaded.counts.totalWeights, checkpoint.counts.totalWeights);
+}
+
+TEST_F(CheckpointTest, SaveReplacesPreviousCheckpoint)
+{
+    Checkpoint first;
+    first.position = 1;
+    first.save(path);
+
+    Checkpoint second;
+    second.position = 2;
+    second.save(path);
+
+    EXPECT_EQ(Checkpoint::load(path).position, 2);
+    EXPECT_FALSE(fs::exists(path + ".tmp"));
+}
+
+TEST_F(CheckpointTest, LoadNonExistentFileThrows)
+{
+    EXPECT_THROW(Checkpoint::load(path), std::runtime_error);
+}
+
+TEST_F(CheckpointTest, LoadInvalidFileThrows)
+{
+    std::ofstream(path) << "garbage";
+    EXPECT_THROW(Checkpoint::load(path), std::runtime_error);
+}
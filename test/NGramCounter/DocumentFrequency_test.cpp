@@ -0,0 +1,149 @@
+#include <DocumentFrequency.h>
+#include <NGramCounter.h>
+#include <NGramCounts.h>
+#include <RandomWords.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+// Document frequencies computed directly from the distinct normalized substrings of each word
+std::vector<DocumentFrequencyMap> referenceFrequencies(WordList const & words)
+{
+    std::vector<DocumentFrequencyMap> result;
+    for (auto const & [word, weight] : words)
+    {
+        std::set<std::string> distinct;
+        for (size_t n = 1; n <= word.size(); ++n)
+        {
+            for (size_t i = 0; i + n <= word.size(); ++i)
+            {
+                distinct.insert(replaceSpecialSequences(word.substr(i, n)));
+            }
+        }
+        for (auto const & ngram : distinct)
+        {
+            result.resize(std::max(result.size(), ngram.size() + 1));
+            result[ngram.size()][ngram].words += 1;
+            result[ngram.size()][ngram].weight += weight;
+        }
+    }
+    return result;
+}
+
+// Expects two sets of document frequencies to be equal up to rounding
+void expectFrequenciesNear(std::vector<DocumentFrequencyMap> const & actual,
+                           std::vector<DocumentFrequencyMap> const & expected)
+{
+    for (size_t n = 0; n < std::max(actual.size(), expected.size()); ++n)
+    {
+        DocumentFrequencyMap const empty;
+        auto const &               a = (n < actual.size()) ? actual[n] : empty;
+        auto const &               e = (n < expected.size()) ? expected[n] : empty;
+        ASSERT_EQ(a.size(), e.size()) << n << "-grams";
+        for (auto const & [ngram, frequency] : e)
+        {
+            auto found = a.find(ngram);
+            ASSERT_NE(found, a.end()) << ngram;
+            EXPECT_EQ(found->second.words, frequency.words) << ngram;
+            EXPECT_NEAR(found->second.weight, frequency.weight, 1e-9 * frequency.weight) << ngram;
+        }
+    }
+}
+
+} // anonymous namespace
+
+// ========== Document Frequency Tests ==========
+
+TEST(DocumentFrequencyTest, RepeatedNGramsCountOncePerWord)
+{
+    WordList                          words = {{"banana", 2.0}, {"band", 3.0}};
+    NGramCounts                       counts;
+    std::vector<DocumentFrequencyMap> frequencies;
+    countDocumentFrequencies(counts, frequencies, words, 0, words.size(), CountingOptions());
+
+    // "an" occurs twice in "banana" and once in "band"
+    EXPECT_DOUBLE_EQ(counts.ngramMaps[2]["an"], 2 * 2.0 + 3.0);
+    EXPECT_EQ(frequencies[2]["an"], (DocumentFrequency{2, 5.0}));
+    EXPECT_EQ(frequencies[3]["ana"], (DocumentFrequency{1, 2.0}));
+    EXPECT_EQ(frequencies[1]["d"], (DocumentFrequency{1, 3.0}));
+}
+
+TEST(DocumentFrequencyTest, MatchesReferenceAtEveryThreadCount)
+{
+    WordList const words    = randomWords(1, 3000, "aeqquywwnt", 16, 0.25, "'");
+    auto const     expected = referenceFrequencies(words);
+
+    NGramCounts reference;
+    for (auto const & [word, weight] : words)
+    {
+        reference.addWord(word, weight);
+    }
+
+    for (unsigned threads : {1u, 2u, 3u, 8u})
+    {
+        SCOPED_TRACE(std::to_string(threads) + " threads");
+        CountingOptions options;
+        options.threads = threads;
+
+        NGramCounts                       counts;
+        std::vector<DocumentFrequencyMap> frequencies;
+        countDocumentFrequencies(counts, frequencies, words, 0, words.size(), options);
+        expectFrequenciesNear(frequencies, expected);
+
+        ASSERT_EQ(counts.ngramMaps.size(), reference.ngramMaps.size());
+        for (size_t n = 1; n < reference.ngramMaps.size(); ++n)
+        {
+            EXPECT_NEAR(counts.totalWeights[n], reference.totalWeights[n], 1e-9 * reference.totalWeights[n]);
+            ASSERT_EQ(counts.ngramMaps[n].size(), reference.ngramMaps[n].size());
+            for (auto const & [ngram, weight] : reference.ngramMaps[n])
+            {
+                EXPECT_NEAR(counts.ngramMaps[n][ngram], weight, 1e-9 * weight) << ngram;
+            }
+        }
+    }
+}
+
+TEST(DocumentFrequencyTest, ChunksAccumulate)
+{
+    WordList const                    words = randomWords(2, 500, "aeqquywwnt", 16, 0.25, "'");
+    NGramCounts                       counts;
+    std::vector<DocumentFrequencyMap> frequencies;
+    for (size_t begin = 0; begin < words.size(); begin += 77)
+    {
+        countDocumentFrequencies(counts, frequencies, words, begin, std::min(begin + 77, words.size()), CountingOptions());
+    }
+    expectFrequenciesNear(frequencies, referenceFrequencies(words));
+}
+
+TEST(DocumentFrequencyTest, ThresholdDropsTheSameNGrams)
+{
+    WordList const  words = randomWords(3, 1000, "aeqquywwnt", 16, 0.25, "'");
+    CountingOptions options;
+    options.minWeight = 40.0;
+
+    NGramCounts                       counts;
+    std::vector<DocumentFrequencyMap> frequencies;
+    countDocumentFrequencies(counts, frequencies, words, 0, words.size(), options);
+
+    auto expected = referenceFrequencies(words);
+    for (size_t n = 0; n < expected.size(); ++n)
+    {
+        for (auto it = expected[n].begin(); it != expected[n].end();)
+        {
+            it = (counts.ngramMaps[n].count(it->first) == 0) ? expected[n].erase(it) : std::next(it);
+        }
+        for (auto const & [ngram, weight] : counts.ngramMaps[n])
+        {
+            EXPECT_GE(weight, options.minWeight) << ngram;
+        }
+    }
+    expectFrequenciesNear(frequencies, expected);
+}
@@ -0,0 +1,117 @@
+#include <EngineSelection.h>
+#include <HyperLogLog.h>
+#include <NGramCounter.h>
+#include <NGramCounts.h>
+#include <RandomWords.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+// ========== HyperLogLog Tests ==========
+
+TEST(HyperLogLogTest, EstimatesDistinctItems)
+{
+    for (size_t distinct : {0u, 10u, 1000u, 100000u})
+    {
+        HyperLogLog estimator;
+        for (size_t i = 0; i < 3 * distinct; ++i)
+        {
+            estimator.add(i % distinct + 1);
+        }
+        EXPECT_NEAR(estimator.estimate(), static_cast<double>(distinct), 0.05 * static_cast<double>(distinct) + 0.5)
+            << distinct;
+    }
+}
+
+TEST(HyperLogLogTest, MergeEstimatesTheUnion)
+{
+    HyperLogLog a;
+    HyperLogLog b;
+    for (uint64_t i = 0; i < 20000; ++i)
+    {
+        a.add(i);
+        b.add(i + 10000);
+    }
+    a.merge(b);
+    EXPECT_NEAR(a.estimate(), 30000.0, 1500.0);
+    EXPECT_THROW(a.merge(HyperLogLog(10)), std::invalid_argument);
+    EXPECT_THROW(HyperLogLog(2), std::invalid_argument);
+}
+
+// ========== Engine Selection Tests ==========
+
+TEST(EngineSelectionTest, EstimateMatchesTheCounts)
+{
+    WordList const words = randomWords(1, 3000, "etaonqusyw", 10, 1.0);
+    NGramCounts    counts;
+    for (auto const & [word, weight] : words)
+    {
+        counts.addWord(word, weight);
+    }
+
+    for (unsigned threads : {1u, 3u})
+    {
+        NGramEstimate estimate = estimateNGrams(words, 0, words.size(), threads);
+        ASSERT_EQ(estimate.distinctNGrams.size(), counts.ngramMaps.size());
+        for (size_t n = 1; n < counts.ngramMaps.size(); ++n)
+        {
+            double const distinct = static_cast<double>(counts.ngramMaps[n].size());
+            EXPECT_NEAR(estimate.distinctNGrams[n], distinct, 0.05 * distinct + 1.0) << n << "-grams";
+            EXPECT_DOUBLE_EQ(estimate.totalWeights[n], counts.totalWeights[n]) << n << "-grams";
+        }
+    }
+}
+
+TEST(EngineSelectionTest, ChoosesTheFastestEngineThatFits)
+{
+    WordList const  words = randomWords(2, 2000, "etaonqusyw", 10, 1.0);
+    CountingOptions options;
+
+    // Without a limit the fastest engine is chosen
+    EngineSelection selection = selectCountingEngine(words, 0, words.size(), options, 1e18);
+    EXPECT_TRUE(selection.fits);
+    EXPECT_EQ(selection.engine, CountingEngine::Kernel);
+    ASSERT_EQ(selection.candidates.size(), 3u);
+
+    // Below every estimate, the smallest is chosen
+    selection = selectCountingEngine(words, 0, words.size(), options, 1.0);
+    EXPECT_FALSE(selection.fits);
+    auto const smallest = std::min_element(selection.candidates.begin(),
+                                           selection.candidates.end(),
+                                           [](EngineCandidate const & a, EngineCandidate const & b)
+                                           { return a.bytes < b.bytes; });
+    EXPECT_EQ(selection.engine, smallest->engine);
+
+    // At the estimate of an engine, the engines before it do not fit
+    for (size_t i = 0; i < selection.candidates.size(); ++i)
+    {
+        double const    limit  = selection.candidates[i].bytes;
+        EngineSelection chosen = selectCountingEngine(words, 0, words.size(), options, limit);
+        EXPECT_TRUE(chosen.fits);
+        for (auto const & candidate : chosen.candidates)
+        {
+            if (candidate.engine == chosen.engine)
+            {
+                break;
+            }
+            EXPECT_GT(candidate.bytes, limit);
+        }
+    }
+}
+
+TEST(EngineSelectionTest, ThresholdConsidersThresholdedEngines)
+{
+    WordList const  words = randomWords(3, 2000, "etaonqusyw", 10, 1.0);
+    CountingOptions options;
+    options.minWeight         = 50.0;
+    EngineSelection selection = selectCountingEngine(words, 0, words.size(), options, 1e18);
+    EXPECT_EQ(selection.engine, CountingEngine::Levelwise);
+    EXPECT_EQ(selection.candidates.size(), 5u);
+
+    // A threshold can only shrink the result
+    CountingOptions unthresholded;
+    EXPECT_LE(estimateEngineMemory(CountingEngine::Levelwise, selection.estimate, options),
+              estimateEngineMemory(CountingEngine::Levelwise, selection.estimate, unthresholded));
+}
@@ -0,0 +1,142 @@
+#include <JsonWriter.h>
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+
+// Writes a double with a JsonWriter
+std::string writeDouble(double x)
+{
+    std::ostringstream out;
+    {
+        JsonWriter writer(out);
+        writer.value(x);
+    }
+    return out.str();
+}
+
+// Doubles of every magnitude, with random bits and with few digits
+std::vector<double> testDoubles()
+{
+    std::vector<double> values = {0.0,
+                                  -0.0,
+                                  1.0,
+                                  -2.5,
+                                  0.1,
+                                  1e-4,
+                                  1.5e-4,
+                                  1e-5,
+                                  123456789012345.0,
+                                  1234567890123456.0,
+                                  1e15,
+                                  1e16,
+                                  1e100,
+                                  5e-324,
+                                  std::numeric_limits<double>::max(),
+                                  std::numeric_limits<double>::min()};
+    std::mt19937_64 rng(1);
+    for (int i = 0; i < 20000; ++i)
+    {
+        uint64_t bits = rng();
+        double   x;
+        std::memcpy(&x, &bits, sizeof(x));
+        if (std::isfinite(x))
+        {
+            values.push_back(x);
+        }
+        values.push_back(static_cast<double>(rng() % 100000) * std::pow(10.0, static_cast<int>(rng() % 40) - 20));
+        values.push_back(static_cast<double>(rng() % 1000) / 100.0 + static_cast<double>(rng() % 7) / 3.0);
+    }
+    return values;
+}
+
+} // anonymous namespace
+
+// ========== JsonWriter Tests ==========
+
+TEST(JsonWriterTest, DoublesMatchNlohmann)
+{
+    // nlohmann::json's Grisu2 digits are not always the shortest, nor the closest of the shortest. Where they differ, the
+    // writer's digits must be no more and read back as the same double.
+    size_t differences = 0;
+    for (double x : testDoubles())
+    {
+        std::string const expected = nlohmann::json(x).dump();
+        std::string const actual   = writeDouble(x);
+        if (actual != expected)
+        {
+            ++differences;
+            EXPECT_EQ(std::strtod(actual.c_str(), nullptr), x) << actual;
+            EXPECT_LE(actual.size(), expected.size()) << "expected " << expected << ", got " << actual;
+        }
+    }
+    EXPECT_LT(differences, testDoubles().size() / 100);
+    EXPECT_EQ(writeDouble(std::numeric_limits<double>::infinity()), "null");
+    EXPECT_EQ(writeDouble(std::nan("")), "null");
+}
+
+TEST(JsonWriterTest, DocumentMatchesNlohmannDump)
+{
+    std::vector<std::unordered_map<std::string, double>> maps(3);
+    maps[1] = {{"b", 2.0}, {"a", 0.25}, {"Q", 1e-7}, {"n't", 3.0}, {"\"\\\t\x01", 4.0}, {"caf\xc3\xa9", 5.0}};
+    maps[2] = {{"ab", 1.0 / 3.0}};
+    std::map<std::string, std::map<std::string, uint64_t>> const nested = {{"x", {{"words", 3}, {"max", 1ull << 63}}},
+                                                                           {"empty", {}}};
+
+    nlohmann::json expected;
+    expected["maps"]   = maps;
+    expected["nested"] = nested;
+    expected["list"]   = {1.5, "text", nlohmann::json::array(), nlohmann::json::object()};
+
+    std::ostringstream out;
+    {
+        // A small buffer is written to the stream many times
+        JsonWriter writer(out, 16);
+        writer.beginObject();
+        writer.key("list");
+        writer.beginArray();
+        writer.value(1.5);
+        writer.value("text");
+        writer.beginArray();
+        writer.endArray();
+        writer.beginObject();
+        writer.endObject();
+        writer.endArray();
+        writer.key("maps");
+        writer.beginArray();
+        for (auto const & map : maps)
+        {
+            writeSortedObject(writer, map, [](JsonWriter & w, double weight) { w.value(weight); });
+        }
+        writer.endArray();
+        writer.key("nested");
+        writeSortedObject(writer,
+                          nested,
+                          [](JsonWriter & w, auto const & inner)
+                          { writeSortedObject(w, inner, [](JsonWriter & v, uint64_t n) { v.value(n); }); });
+        writer.endObject();
+    }
+    EXPECT_EQ(out.str(), expected.dump(2));
+}
+
+TEST(JsonWriterTest, InvalidUtf8IsReplaced)
+{
+    std::ostringstream out;
+    {
+        JsonWriter writer(out);
+        writer.value(std::string_view("a\xc3(b\xed\xa0\x80"));
+    }
+    EXPECT_EQ(out.str(), "\"a\xef\xbf\xbd(b\xef\xbf\xbd\xef\xbf\xbd\xef\xbf\xbd\"");
+}
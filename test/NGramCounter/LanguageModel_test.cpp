@@ -0,0 +1,221 @@
+#include <LanguageModel.h>
+#include <NGramCounts.h>
+#include <NGramKey.h>
+#include <RandomWords.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+
+// Number of symbols in the normalized alphabet
+size_t const ALPHABET_SIZE = VOWELS.size() + CONSONANTS.size();
+
+// Counts of random words over a few letters
+NGramCounts randomCounts(unsigned seed)
+{
+    NGramCounts  counts;
+    std::mt19937 rng(seed);
+    for (int w = 0; w < 300; ++w)
+    {
+        std::string word(1 + rng() % 8, ' ');
+        for (auto & c : word)
+        {
+            c = "etaonqusyw"[rng() % 10];
+        }
+        counts.addWord(word, 0.5 * (1 + rng() % 20));
+    }
+    return counts;
+}
+
+// Random words over letters that are normalized in different ways, without their weights
+std::vector<std::string> randomWordsOnly(unsigned seed, size_t count)
+{
+    std::vector<std::string> words;
+    for (auto & [word, weight] : randomWords(seed, count, "equywaoxt", 9, 1.0))
+    {
+        words.push_back(std::move(word));
+    }
+    return words;
+}
+
+// Returns the sum of the probabilities of every symbol following a context
+double totalProbability(LanguageModel const & model, std::string const & context)
+{
+    NGramKey key    = context.empty() ? 0 : packNGram(context);
+    double   result = 0.0;
+    for (unsigned code = 1; code <= ALPHABET_SIZE; ++code)
+    {
+        result += model.probability(key, context.size(), code);
+    }
+    return result;
+}
+
+} // anonymous namespace
+
+// ========== LanguageModel Tests ==========
+
+TEST(LanguageModelTest, DefaultModelIsUniform)
+{
+    LanguageModel model;
+    EXPECT_EQ(model.order(), 1u);
+    EXPECT_DOUBLE_EQ(model.probability(0, 0, symbolCode('e')), 1.0 / ALPHABET_SIZE);
+    EXPECT_DOUBLE_EQ(model.logProbability("the"), 3 * std::log2(1.0 / ALPHABET_SIZE));
+}
+
+TEST(LanguageModelTest, ProbabilitiesSumToOne)
+{
+    NGramCounts counts = randomCounts(1);
+    for (size_t order : {1u, 2u, 3u, 4u})
+    {
+        LanguageModel model = LanguageModel::build(counts, order);
+        EXPECT_EQ(model.order(), order);
+
+        // Contexts that were seen, seen only in part, and never seen
+        for (std::string context : {"", "e", "t", "Q", "z", "et", "ta", "zz", "eta", "nQe", "zzz"})
+        {
+            if (context.size() < order)
+            {
+                EXPECT_NEAR(totalProbability(model, context), 1.0, 1e-12) << "order " << order << ", context " << context;
+            }
+        }
+    }
+}
+
+TEST(LanguageModelTest, InterpolatedKneserNeyBigram)
+{
+    // Unigrams come from the continuation counts of the bigrams "ab", "ac" and "bc": a 0, b 1, c 2. The counts are all
+    // whole units with one count of 1 and one of 2, so the unigram discount is 1 / (1 + 2 * 1) = 1/3.
+    NGramCounts counts;
+    counts.addNGram("a", 1.0);
+    counts.addNGram("ab", 2.0);
+    counts.addNGram("ac", 4.0);
+    counts.addNGram("bc", 2.0);
+
+    LanguageModel model = LanguageModel::build(counts, 2);
+    double const  v     = static_cast<double>(ALPHABET_SIZE);
+
+    double const unigramDiscount = 1.0 / 3.0;
+    double const unigramBackoff  = unigramDiscount * 2 / 3;
+    double const pB              = (1 - unigramDiscount) / 3 + unigramBackoff / v;
+    double const pC              = (2 - unigramDiscount) / 3 + unigramBackoff / v;
+    double const pE              = unigramBackoff / v;
+    EXPECT_NEAR(model.probability(0, 0, symbolCode('b')), pB, 1e-12);
+    EXPECT_NEAR(model.probability(0, 0, symbolCode('c')), pC, 1e-12);
+    EXPECT_NEAR(model.probability(0, 0, symbolCode('e')), pE, 1e-12);
+
+    // Bigram weights in units of 2: "ab" 1, "ac" 2 and "bc" 1, so the discount is 2 * 2 / (2 + 2 * 1) = 1
+    double const bigramDiscount = 1.0;
+    double const backoffA       = bigramDiscount * 2 / 6;
+    NGramKey     a              = packNGram("a");
+    EXPECT_NEAR(model.probability(a, 1, symbolCode('b')), (2 - bigramDiscount) / 6 + backoffA * pB, 1e-12);
+    EXPECT_NEAR(model.probability(a, 1, symbolCode('c')), (4 - bigramDiscount) / 6 + backoffA * pC, 1e-12);
+    EXPECT_NEAR(model.probability(a, 1, symbolCode('e')), backoffA * pE, 1e-12);
+
+    // An unseen context backs off to the unigrams
+    EXPECT_NEAR(model.probability(packNGram("e"), 1, symbolCode('c')), pC, 1e-12);
+
+    // The first symbol of a word is predicted by the unigrams
+    EXPECT_NEAR(model.logProbability("ac"),
+                std::log2(model.probability(0, 0, symbolCode('a'))) + std::log2(model.probability(a, 1, symbolCode('c'))),
+                1e-12);
+}
+
+TEST(LanguageModelTest, LogProbabilityNormalizesTheWord)
+{
+    LanguageModel model = LanguageModel::build(randomCounts(2), 3);
+
+    // "queen" is scored as the symbols "Qeen"
+    NGramKey const q       = packNGram("Q");
+    NGramKey const qe      = packNGram("Qe");
+    NGramKey const ee      = packNGram("ee");
+    double         product = model.probability(0, 0, symbolCode('Q')) * model.probability(q, 1, symbolCode('e')) *
+                     model.probability(qe, 2, symbolCode('e')) * model.probability(ee, 2, symbolCode('n'));
+    EXPECT_NEAR(model.logProbability("queen"), std::log2(product), 1e-12);
+    EXPECT_EQ(model.logProbability("don't"), -INFINITY);
+    EXPECT_EQ(model.logProbability(""), 0.0);
+}
+
+TEST(LanguageModelTest, LogProbabilityMatchesTheNormalizedSymbols)
+{
+    LanguageModel model = LanguageModel::build(randomCounts(5), 4);
+    for (auto const & word : randomWordsOnly(6, 500))
+    {
+        std::string normalized = replaceSpecialSequences(word);
+        double      expected   = 0.0;
+        for (size_t i = 0; i < normalized.size(); ++i)
+        {
+            size_t   length  = std::min<size_t>(i, model.order() - 1);
+            NGramKey context = (length == 0) ? 0 : packNGram(std::string_view(normalized).substr(i - length, length));
+            expected += std::log2(model.probability(context, length, symbolCode(normalized[i])));
+        }
+        EXPECT_NEAR(model.logProbability(word), expected, 1e-9) << word;
+    }
+}
+
+TEST(LanguageModelTest, ScoreBatchMatchesLogProbability)
+{
+    LanguageModel                 model = LanguageModel::build(randomCounts(7), 3);
+    std::vector<std::string>      words = randomWordsOnly(8, 5000);
+    std::vector<std::string_view> views(words.begin(), words.end());
+    views.push_back("don't");
+
+    for (unsigned threads : {1u, 2u, 3u, 8u})
+    {
+        std::vector<double> scores = model.scoreBatch(views, threads);
+        ASSERT_EQ(scores.size(), views.size());
+        for (size_t i = 0; i < views.size(); ++i)
+        {
+            EXPECT_EQ(scores[i], model.logProbability(views[i])) << views[i] << ", " << threads << " threads";
+        }
+    }
+    EXPECT_TRUE(model.scoreBatch(std::vector<std::string_view>(), 4).empty());
+}
+
+TEST(LanguageModelTest, OrderIsLimitedByTheCounts)
+{
+    NGramCounts counts;
+    counts.addWord("ab", 1.0);
+    EXPECT_EQ(LanguageModel::build(counts, 5).order(), 2u);
+    EXPECT_EQ(LanguageModel::build(NGramCounts(), 3).order(), 1u);
+    EXPECT_THROW(LanguageModel::build(counts, 0), std::invalid_argument);
+    EXPECT_THROW(LanguageModel::build(counts, MAX_PACKED_NGRAM_LENGTH + 1), std::invalid_argument);
+}
+
+TEST(LanguageModelTest, WriteReadRoundTrip)
+{
+    LanguageModel model = LanguageModel::build(randomCounts(3), 3);
+
+    std::stringstream stream;
+    model.write(stream);
+    LanguageModel copy = LanguageModel::read(stream);
+
+    EXPECT_EQ(copy.order(), model.order());
+    for (std::string word : {"tea", "quota", "yawn", "zzz", "snowy"})
+    {
+        EXPECT_EQ(copy.logProbability(word), model.logProbability(word)) << word;
+    }
+
+    std::stringstream rewritten;
+    copy.write(rewritten);
+    EXPECT_EQ(rewritten.str(), stream.str());
+}
+
+TEST(LanguageModelTest, ReadRejectsInvalidData)
+{
+    std::stringstream garbage("not a model");
+    EXPECT_THROW(LanguageModel::read(garbage), std::runtime_error);
+
+    std::stringstream stream;
+    LanguageModel::build(randomCounts(4), 2).write(stream);
+    std::stringstream truncated(stream.str().substr(0, stream.str().size() - 5));
+    EXPECT_THROW(LanguageModel::read(truncated), std::runtime_error);
+}
@@ -0,0 +1,145 @@
+#include <NGramCounts.h>
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+// ========== replaceSpecialSequences() Tests ==========
+
+TEST(ReplaceSpecialSequencesTest, PlainStringIsUnchanged)
+{
+    EXPECT_EQ(replaceSpecialSequences("hello"), "hello");
+    EXPECT_EQ(replaceSpecialSequences(""), "");
+}
+
+TEST(ReplaceSpecialSequencesTest, QuBecomesQ)
+{
+    EXPECT_EQ(replaceSpecialSequences("queen"), "Qeen");
+    EXPECT_EQ(replaceSpecialSequences("qu"), "Q");
+    EXPECT_EQ(replaceSpecialSequences("q"), "q");
+}
+
+TEST(ReplaceSpecialSequencesTest, YAfterVowelOrConsonantBecomesVowelY)
+{
+    EXPECT_EQ(replaceSpecialSequences("day"), "daY");
+    EXPECT_EQ(replaceSpecialSequences("my"), "mY");
+    EXPECT_EQ(replaceSpecialSequences("yes"), "yes");
+    EXPECT_EQ(replaceSpecialSequences("iy"), "iy");
+}
+
+TEST(ReplaceSpecialSequencesTest, WAfterCertainVowelsBecomesVowelW)
+{
+    EXPECT_EQ(replaceSpecialSequences("saw"), "saW");
+    EXPECT_EQ(replaceSpecialSequences("new"), "neW");
+    EXPECT_EQ(replaceSpecialSequences("iw"), "iw");
+    EXPECT_EQ(replaceSpecialSequences("we"), "we");
+}
+
+TEST(ReplaceSpecialSequencesTest, ReplacedCharacterIsNotReconsidered)
+{
+    // The second 'y' follows a 'y' that was already replaced, so it is left alone
+    EXPECT_EQ(replaceSpecialSequences("ayy"), "aYy");
+    EXPECT_EQ(replaceSpecialSequences("yy"), "yY");
+}
+
+// ========== addWord() Tests ==========
+
+TEST(NGramCountsTest, AddWordCountsAllSubstrings)
+{
+    NGramCounts counts;
+    counts.addWord("abab", 2.0);
+
+    ASSERT_EQ(counts.ngramMaps.size(), 5);
+    EXPECT_DOUBLE_EQ(counts.ngramMaps[1].at("a"), 4.0);
+    EXPECT_DOUBLE_EQ(counts.ngramMaps[1].at("b"), 4.0);
+    EXPECT_DOUBLE_EQ(counts.ngramMaps[2].at("ab"), 4.0);
+    EXPECT_DOUBLE_EQ(counts.ngramMaps[2].at("ba"), 2.0);
+    EXPECT_DOUBLE_EQ(counts.ngramMaps[4].at("abab"), 2.0);
+    EXPECT_DOUBLE_EQ(counts.totalWeights[1], 8.0);
+    EXPECT_DOUBLE_EQ(counts.totalWeights[3], 4.0);
+    EXPECT_DOUBLE_EQ(counts.totalWeights[4], 2.0);
+}
+
+TEST(NGramCountsTest, AddWordCountsNormalizedLength)
+{
+    NGramCounts counts;
+    counts.addWord("quit", 1.0);
+
+    // "qu" is counted as the 1-gram "Q", and "qui" as the 2-gram "Qi"
+    EXPECT_DOUBLE_EQ(counts.ngramMaps[1].at("Q"), 1.0);
+    EXPECT_DOUBLE_EQ(counts.ngramMaps[1].at("q"), 1.0);
+    EXPECT_DOUBLE_EQ(counts.ngramMaps[2].at("Qi"), 1.0);
+    EXPECT_DOUBLE_EQ(counts.ngramMaps[3].at("Qit"), 1.0);
+    EXPECT_EQ(counts.ngramMaps[4].size(), 0);
+    EXPECT_DOUBLE_EQ(counts.totalWeights[2], 3.0);
+}
+
+TEST(NGramCountsTest, MergeAddsCounts)
+{
+    NGramCounts a;
+    NGramCounts b;
+    a.addWord("ab", 1.0);
+    b.addWord("abc", 2.0);
+    a.merge(b);
+
+    EXPECT_EQ(a.ngramMaps.size(), 4);
+    EXPECT_DOUBLE_EQ(a.ngramMaps[2].at("ab"), 3.0);
+    EXPECT_DOUBLE_EQ(a.ngramMaps[3].at("abc"), 2.0);
+    EXPECT_DOUBLE_EQ(a.totalWeights[1], 8.0);
+}
+
+// ========== write() / read() Tests ==========
+
+TEST(NGramCountsTest, WriteReadRoundTrip)
+{
+    NGramCounts counts;
+    counts.addWord("quality", 1.25);
+    counts.addWord("yellow", 0.5);
+
+    std::stringstream stream;
+    counts.write(stream);
+    NGramCounts loaded = NGramCounts::read(stream);
+
+    EXPECT_EQ(loaded.ngramMaps, counts.ngramMaps);
+    EXPECT_EQ(loaded.totalWeights, counts.totalWeights);
+}
+
+TEST(NGramCountsTest, ReadRejectsInvalidData)
+{
+    std::stringstream stream("not a frozen table");
+    EXPECT_THROW(NGramCounts::read(stream), std::runtime_error);
+}
+
+TEST(NGramCountsTest, ReadRejectsTruncatedData)
+{
+    NGramCounts counts;
+    counts.addWord("truncated", 1.0);
+    std::stringstream stream;
+    counts.write(stream);
+
+    std::string       data = stream.str();
+    std::stringstream truncated(data.substr(0, data.size() - 3));
+    EXPECT_THROW(NGramCounts::read(truncated), std::runtime_error);
+}
+
+TEST(NGramCountsTest, ReadRejectsCorruptCountsBeforeAllocating)
+{
+    NGramCounts counts;
+    counts.addWord("corrupt", 1.0);
+    std::stringstream stream;
+    counts.write(stream);
+    std::string const data = stream.str();
+
+    // The number of lengths follows the magic number and version, and the first table's entry count its total weight
+    for (size_t offset : {size_t(8), size_t(20)})
+    {
+        std::string corrupt = data;
+        for (size_t i = 0; i < 4; ++i)
+        {
+            corrupt[offset + i] = '\xff';
+        }
+        std::stringstream in(corrupt);
+        EXPECT_THROW(NGramCounts::read(in), std::runtime_error) << "offset " << offset;
+    }
+}
@@ -0,0 +1,180 @@
+#include <Alphabet.h>
+#include <NGramCounts.h>
+#include <NGramIndex.h>
+#include <NGramKey.h>
+#include <RandomWords.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+// Ids of the words containing a normalized n-gram, found by normalizing every substring of every word
+std::vector<uint32_t> referencePostings(NGramIndex const & index, std::string const & ngram)
+{
+    std::vector<uint32_t> ids;
+    for (uint32_t id = 0; id < index.size(); ++id)
+    {
+        std::string_view const word  = index.word(id);
+        bool                   found = false;
+        for (size_t n = 1; n <= word.size() && !found; ++n)
+        {
+            for (size_t i = 0; i <= word.size() - n && !found; ++i)
+            {
+                found = replaceSpecialSequences(word.substr(i, n)) == ngram;
+            }
+        }
+        if (found)
+        {
+            ids.push_back(id);
+        }
+    }
+    return ids;
+}
+
+} // anonymous namespace
+
+// ========== NGramIndex Tests ==========
+
+TEST(NGramIndexTest, NumbersWordsByDecreasingWeight)
+{
+    WordList const   words = {{"b", 1.0}, {"a", 3.0}, {"c", 1.0}, {"d", 2.0}};
+    NGramIndex const index = NGramIndex::build(words);
+    ASSERT_EQ(index.size(), 4u);
+    EXPECT_EQ(index.word(0), "a");
+    EXPECT_EQ(index.word(1), "d");
+    EXPECT_EQ(index.word(2), "b");
+    EXPECT_EQ(index.word(3), "c");
+    EXPECT_EQ(index.weight(1), 2.0);
+}
+
+TEST(NGramIndexTest, PostingsMatchAScan)
+{
+    WordList const words = randomWords(1, 1500, "aeqquywnt", 20, 0.5, "'");
+    for (unsigned threads : {1u, 3u})
+    {
+        NGramIndex const index = NGramIndex::build(words, threads);
+        for (std::string ngram : {"a", "Q", "eY", "nt", "aWe", "tna", "Qa", "ee", "nnnn", "t'", "zz", ""})
+        {
+            EXPECT_EQ(index.postings(ngram), packNGram(ngram) ? referencePostings(index, ngram) : std::vector<uint32_t>{})
+                << ngram << ", " << threads << " threads";
+        }
+    }
+}
+
+TEST(NGramIndexTest, WordsWithAllIntersectsPostings)
+{
+    WordList const   words = randomWords(2, 2000, "aeqquywnt", 20, 0.5, "'");
+    NGramIndex const index = NGramIndex::build(words);
+
+    std::vector<std::string> const ngrams = {"nt", "a", "eY"};
+    std::vector<uint32_t>          expected(index.size());
+    for (uint32_t id = 0; id < index.size(); ++id)
+    {
+        expected[id] = id;
+    }
+    for (auto const & ngram : ngrams)
+    {
+        std::vector<uint32_t> const postings = index.postings(ngram);
+        std::vector<uint32_t>       both;
+        std::set_intersection(
+            expected.begin(), expected.end(), postings.begin(), postings.end(), std::back_inserter(both));
+        expected = both;
+    }
+    EXPECT_FALSE(expected.empty());
+    EXPECT_EQ(index.wordsWithAll(ngrams), expected);
+    EXPECT_TRUE(index.wordsWithAll({"a", "zz"}).empty());
+    EXPECT_EQ(index.wordsWithAll({}).size(), index.size());
+}
+
+TEST(NGramIndexTest, WordsContainingMatchesAScan)
+{
+    WordList const   words = randomWords(3, 2000, "aeqquywnt", 20, 0.5, "'");
+    NGramIndex const index = NGramIndex::build(words);
+
+    // Short and long substrings, with special sequences and characters outside the normalized alphabet
+    std::mt19937 rng(4);
+    for (int query = 0; query < 200; ++query)
+    {
+        std::string_view const word      = index.word(static_cast<uint32_t>(rng() % index.size()));
+        size_t const           start     = rng() % word.size();
+        std::string const      substring = std::string(word.substr(start, 1 + rng() % (word.size() - start)));
+
+        std::vector<uint32_t> expected;
+        for (uint32_t id = 0; id < index.size(); ++id)
+        {
+            if (index.word(id).find(substring) != std::string_view::npos)
+            {
+                expected.push_back(id);
+            }
+        }
+        EXPECT_EQ(index.wordsContaining(substring), expected) << substring;
+    }
+    EXPECT_EQ(index.wordsContaining("").size(), index.size());
+    EXPECT_TRUE(index.wordsContaining("zz").empty());
+}
+
+TEST(NGramIndexTest, PacksWithTheAlphabet)
+{
+    WordList const   words    = randomWords(6, 1500, "aeqquywnt", 20, 0.5, "'");
+    Alphabet const   alphabet = Alphabet::fromWords(words);
+    NGramIndex const index    = NGramIndex::build(words, 2, alphabet);
+
+    // The apostrophe is a symbol, so the n-grams containing it have posting lists
+    for (std::string ngram : {"t'", "'", "n'a", "eY"})
+    {
+        EXPECT_EQ(index.postings(ngram), referencePostings(index, ngram)) << ngram;
+    }
+    EXPECT_FALSE(index.postings("t'").empty());
+
+    std::mt19937 rng(7);
+    for (int query = 0; query < 100; ++query)
+    {
+        std::string_view const word      = index.word(static_cast<uint32_t>(rng() % index.size()));
+        size_t const           start     = rng() % word.size();
+        std::string const      substring = std::string(word.substr(start, 1 + rng() % (word.size() - start)));
+
+        std::vector<uint32_t> expected;
+        for (uint32_t id = 0; id < index.size(); ++id)
+        {
+            if (index.word(id).find(substring) != std::string_view::npos)
+            {
+                expected.push_back(id);
+            }
+        }
+        EXPECT_EQ(index.wordsContaining(substring), expected) << substring;
+    }
+}
+
+TEST(NGramIndexTest, IntersectPostingsMatchesSetIntersection)
+{
+    std::mt19937 rng(5);
+    for (size_t sizeA : {0u, 1u, 3u, 7u, 100u, 5000u})
+    {
+        for (size_t sizeB : {0u, 2u, 5u, 64u, 20000u})
+        {
+            std::set<uint32_t> setA;
+            std::set<uint32_t> setB;
+            while (setA.size() < sizeA)
+            {
+                setA.insert(static_cast<uint32_t>(rng() % 30000));
+            }
+            while (setB.size() < sizeB)
+            {
+                setB.insert(static_cast<uint32_t>(rng() % 30000));
+            }
+            std::vector<uint32_t> const a(setA.begin(), setA.end());
+            std::vector<uint32_t> const b(setB.begin(), setB.end());
+            std::vector<uint32_t>       expected;
+            std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+            EXPECT_EQ(intersectPostings(a, b), expected) << sizeA << " and " << sizeB;
+            EXPECT_EQ(intersectPostings(b, a), expected) << sizeB << " and " << sizeA;
+        }
+    }
+}
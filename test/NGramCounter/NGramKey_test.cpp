@@ -0,0 +1,112 @@
+#include <NGramKey.h>
+#include <RadixSort.h>
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+// ========== packNGram() / unpackNGram() Tests ==========
+
+TEST(NGramKeyTest, PackUnpackRoundTrip)
+{
+    for (std::string ngram : {"e", "Q", "the", "aYW", "zzzzzzzzzzzz", "tnhsrldymwgc"})
+    {
+        NGramKey key = packNGram(ngram);
+        EXPECT_NE(key, 0) << ngram;
+        EXPECT_EQ(packedLength(key), ngram.size()) << ngram;
+        EXPECT_EQ(unpackNGram(key), ngram);
+    }
+}
+
+TEST(NGramKeyTest, PackRejectsUnpackableNGrams)
+{
+    EXPECT_EQ(packNGram(""), 0);
+    EXPECT_EQ(packNGram("abc1"), 0);
+    EXPECT_EQ(packNGram("ABC"), 0);
+    EXPECT_EQ(packNGram(std::string(MAX_PACKED_NGRAM_LENGTH + 1, 'a')), 0);
+    EXPECT_FALSE(isPackable("don't"));
+    EXPECT_TRUE(isPackable("quality"));
+}
+
+TEST(NGramKeyTest, KeysOfDifferentLengthsAreDistinct)
+{
+    // Shorter n-grams have smaller keys, so sorting keys groups n-grams by length
+    EXPECT_LT(packNGram("z"), packNGram("ee"));
+    EXPECT_LT(packNGram("zz"), packNGram("eee"));
+    EXPECT_NE(packNGram("e"), packNGram("ee"));
+}
+
+// ========== forEachNormalizedNGram() Tests ==========
+
+TEST(NGramKeyTest, ForEachNormalizedNGramMatchesReplaceSpecialSequences)
+{
+    std::string const letters = "abcdeqquuyywwo";
+    std::mt19937      rng(1);
+    for (int w = 0; w < 500; ++w)
+    {
+        std::string word(1 + rng() % MAX_PACKED_NGRAM_LENGTH, ' ');
+        for (auto & c : word)
+        {
+            c = letters[rng() % letters.size()];
+        }
+
+        size_t visits = 0;
+        forEachNormalizedNGram(word,
+                               [&](NGramKey key, size_t length, size_t start, size_t rawLength)
+                               {
+                                   std::string expected = replaceSpecialSequences(word.substr(start, rawLength));
+                                   EXPECT_EQ(length, expected.size()) << word;
+                                   EXPECT_EQ(unpackNGram(key), expected) << word;
+                                   ++visits;
+                               });
+        EXPECT_EQ(visits, word.size() * (word.size() + 1) / 2) << word;
+    }
+}
+
+TEST(NGramKeyTest, ForEachNormalizedNGramReportsLongNGramsWithoutKey)
+{
+    std::string word(MAX_PACKED_NGRAM_LENGTH + 2, 'a');
+    forEachNormalizedNGram(word,
+                           [&](NGramKey key, size_t length, size_t, size_t)
+                           { EXPECT_EQ(key == 0, length > MAX_PACKED_NGRAM_LENGTH); });
+}
+
+// ========== radixSort() / reduceSorted() Tests ==========
+
+TEST(RadixSortTest, SortsStablyWithAnyThreadCount)
+{
+    std::mt19937             rng(2);
+    std::vector<KeyedWeight> input;
+    for (int i = 0; i < 5000; ++i)
+    {
+        input.push_back({(NGramKey(rng() % 50) << 40) | (rng() % 3), static_cast<double>(i)});
+    }
+
+    for (unsigned threads : {1u, 2u, 5u})
+    {
+        std::vector<KeyedWeight> entries = input;
+        radixSort(entries, threads);
+        ASSERT_EQ(entries.size(), input.size());
+        for (size_t i = 1; i < entries.size(); ++i)
+        {
+            ASSERT_LE(entries[i - 1].key, entries[i].key);
+            if (entries[i - 1].key == entries[i].key)
+            {
+                // Weights are the original positions, so equal keys must keep increasing weights
+                ASSERT_LT(entries[i - 1].weight, entries[i].weight);
+            }
+        }
+    }
+}
+
+TEST(RadixSortTest, ReduceSortedSumsEqualKeys)
+{
+    std::vector<KeyedWeight> entries = {{1, 1.0}, {1, 2.0}, {3, 0.5}, {7, 1.0}, {7, 1.0}, {7, 1.0}};
+    reduceSorted(entries);
+    ASSERT_EQ(entries.size(), 3);
+    EXPECT_EQ(entries[0].key, 1);
+    EXPECT_DOUBLE_EQ(entries[0].weight, 3.0);
+    EXPECT_DOUBLE_EQ(entries[1].weight, 0.5);
+    EXPECT_DOUBLE_EQ(entries[2].weight, 3.0);
+}
@@ -0,0 +1,88 @@
+#include <NGramCounts.h>
+#include <NGramStatistics.h>
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <string>
+
+// ========== computeStatistics() Tests ==========
+
+TEST(NGramStatisticsTest, UniformDistribution)
+{
+    NGramCounts counts;
+    for (std::string ngram : {"a", "b", "c", "d"})
+    {
+        counts.addNGram(ngram, 2.5);
+    }
+
+    auto statistics = computeStatistics(counts);
+    ASSERT_EQ(statistics.size(), 2u);
+    EXPECT_NEAR(statistics[1].entropy, 2.0, 1e-12);
+    EXPECT_NEAR(statistics[1].conditionalEntropy, 2.0, 1e-12);
+    EXPECT_NEAR(statistics[1].perplexity, 4.0, 1e-12);
+}
+
+TEST(NGramStatisticsTest, ConditionalEntropyOfTheLastSymbol)
+{
+    // Each of two equally likely first symbols is always followed by the same symbol, so the second symbol carries no
+    // information. The third is equally likely to be either symbol.
+    NGramCounts counts;
+    counts.addNGram("ab", 1.0);
+    counts.addNGram("ba", 1.0);
+    counts.addNGram("aba", 1.0);
+    counts.addNGram("abb", 1.0);
+
+    auto statistics = computeStatistics(counts);
+    ASSERT_EQ(statistics.size(), 4u);
+    EXPECT_NEAR(statistics[2].entropy, 1.0, 1e-12);
+    EXPECT_NEAR(statistics[2].conditionalEntropy, 0.0, 1e-12);
+    EXPECT_NEAR(statistics[2].perplexity, 1.0, 1e-12);
+    EXPECT_NEAR(statistics[3].entropy, 1.0, 1e-12);
+    EXPECT_NEAR(statistics[3].conditionalEntropy, 1.0, 1e-12);
+    EXPECT_NEAR(statistics[3].perplexity, 2.0, 1e-12);
+}
+
+TEST(NGramStatisticsTest, PrunedCountsUseTheTotalWeight)
+{
+    NGramCounts counts;
+    counts.addNGram("a", 1.0);
+    counts.addNGram("b", 3.0);
+    counts.prune(2.0);
+
+    // The remaining n-gram still has probability 3/4
+    auto statistics = computeStatistics(counts);
+    EXPECT_NEAR(statistics[1].entropy, -0.75 * std::log2(0.75), 1e-12);
+}
+
+TEST(NGramStatisticsTest, ResultDoesNotDependOnThreadCount)
+{
+    NGramCounts  counts;
+    std::mt19937 rng(5);
+    for (int w = 0; w < 2000; ++w)
+    {
+        std::string word(1 + rng() % 10, ' ');
+        for (auto & c : word)
+        {
+            c = "etaoinshrdlu"[rng() % 12];
+        }
+        counts.addWord(word, 1.0 + rng() % 100);
+    }
+
+    auto expected = computeStatistics(counts, 1);
+    for (unsigned threads : {2u, 3u, 8u})
+    {
+        auto statistics = computeStatistics(counts, threads);
+        ASSERT_EQ(statistics.size(), expected.size());
+        for (size_t n = 1; n < expected.size(); ++n)
+        {
+            EXPECT_EQ(statistics[n].entropy, expected[n].entropy) << n;
+            EXPECT_EQ(statistics[n].conditionalEntropy, expected[n].conditionalEntropy) << n;
+        }
+    }
+}
+
+TEST(NGramStatisticsTest, EmptyCounts)
+{
+    EXPECT_TRUE(computeStatistics(NGramCounts(), 4).empty());
+}
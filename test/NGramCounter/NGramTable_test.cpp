@@ -0,0 +1,160 @@
+#include <CountMinSketch.h>
+#include <NGramTable.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// ========== NGramTable Tests ==========
+
+TEST(NGramTableTest, AddAccumulatesWeights)
+{
+    NGramTable table;
+    table.add(packNGram("th"), 1.5);
+    table.add(packNGram("he"), 2.0);
+    table.add(packNGram("th"), 0.5);
+
+    EXPECT_EQ(table.size(), 2);
+    EXPECT_DOUBLE_EQ(table.weight(packNGram("th")), 2.0);
+    EXPECT_DOUBLE_EQ(table.weight(packNGram("he")), 2.0);
+    EXPECT_DOUBLE_EQ(table.weight(packNGram("xx")), 0.0);
+}
+
+TEST(NGramTableTest, GrowsPastInitialCapacity)
+{
+    std::mt19937                 rng(3);
+    std::map<NGramKey, double>   expected;
+    NGramTable                   table(4);
+    for (int i = 0; i < 20000; ++i)
+    {
+        NGramKey key = 1 + rng() % 5000;
+        table.add(key, 1.0);
+        expected[key] += 1.0;
+    }
+
+    EXPECT_EQ(table.size(), expected.size());
+    for (auto const & [key, weight] : expected)
+    {
+        EXPECT_DOUBLE_EQ(table.weight(key), weight);
+    }
+}
+
+TEST(NGramTableTest, AddBatchMatchesAdd)
+{
+    // Batches that end inside a window and that make the table grow, with repeated keys in a window
+    std::mt19937             rng(5);
+    std::vector<KeyedWeight> entries(5000);
+    for (auto & entry : entries)
+    {
+        entry = {1 + rng() % 1500, 0.5 * (rng() % 7)};
+    }
+
+    NGramTable expected;
+    NGramTable table(4);
+    for (auto const & entry : entries)
+    {
+        expected.add(entry.key, entry.weight);
+    }
+    for (size_t begin = 0; begin < entries.size(); begin += 77)
+    {
+        table.addBatch(entries.data() + begin, std::min<size_t>(77, entries.size() - begin));
+    }
+    table.addBatch(entries.data(), 0);
+
+    EXPECT_EQ(table.size(), expected.size());
+    expected.forEach([&](NGramKey key, double weight) { EXPECT_EQ(table.weight(key), weight) << key; });
+}
+
+TEST(NGramTableTest, AddToFillsCountsWithoutChangingTotals)
+{
+    NGramTable table;
+    table.add(packNGram("Qe"), 3.0);
+    table.add(packNGram("a"), 1.0);
+
+    NGramCounts counts;
+    table.addTo(counts);
+    EXPECT_DOUBLE_EQ(counts.ngramMaps[2].at("Qe"), 3.0);
+    EXPECT_DOUBLE_EQ(counts.ngramMaps[1].at("a"), 1.0);
+    EXPECT_DOUBLE_EQ(counts.totalWeights[2], 0.0);
+}
+
+// ========== CountMinSketch Tests ==========
+
+TEST(CountMinSketchTest, EstimateIsNeverLessThanTrueWeight)
+{
+    std::mt19937               rng(4);
+    std::map<uint64_t, double> expected;
+    CountMinSketch             sketch(256, 4);
+    for (int i = 0; i < 10000; ++i)
+    {
+        uint64_t item   = rng() % 2000;
+        double   weight = (rng() % 100) / 10.0;
+        sketch.add(item, weight);
+        expected[item] += weight;
+    }
+
+    for (auto const & [item, weight] : expected)
+    {
+        EXPECT_GE(sketch.estimate(item), weight);
+    }
+}
+
+TEST(CountMinSketchTest, EstimateIsExactWithoutCollisions)
+{
+    CountMinSketch sketch(CountMinSketch::widthFor(10.0, 0.001, 1000), 4);
+    sketch.add(1, 2.5);
+    sketch.add(2, 7.5);
+    EXPECT_DOUBLE_EQ(sketch.estimate(1), 2.5);
+    EXPECT_DOUBLE_EQ(sketch.estimate(2), 7.5);
+    EXPECT_DOUBLE_EQ(sketch.estimate(3), 0.0);
+}
+
+TEST(CountMinSketchTest, ConcurrentAddsMatchSerialAdds)
+{
+    // Whole weights are summed exactly in any order
+    CountMinSketch serial(256, 4);
+    CountMinSketch shared(256, 4);
+    for (uint64_t item = 0; item < 4000; ++item)
+    {
+        serial.add(item % 500, 4.0);
+    }
+
+    std::vector<std::thread> threads;
+    for (uint64_t t = 0; t < 4; ++t)
+    {
+        threads.emplace_back(
+            [&, t]
+            {
+                for (uint64_t item = t; item < 4000; item += 4)
+                {
+                    shared.addConcurrently(item % 500, 4.0);
+                }
+            });
+    }
+    for (auto & thread : threads)
+    {
+        thread.join();
+    }
+
+    for (uint64_t item = 0; item < 500; ++item)
+    {
+        EXPECT_EQ(shared.estimate(item), serial.estimate(item));
+    }
+}
+
+TEST(CountMinSketchTest, MergeAddsSketches)
+{
+    CountMinSketch a(1024, 3);
+    CountMinSketch b(1024, 3);
+    a.add(42, 1.0);
+    b.add(42, 2.0);
+    a.merge(b);
+    EXPECT_GE(a.estimate(42), 3.0);
+
+    CountMinSketch c(2048, 3);
+    EXPECT_THROW(a.merge(c), std::invalid_argument);
+}
@@ -0,0 +1,100 @@
+#include <BinaryWriter.h>
+#include <JsonWriter.h>
+#include <OrderedOutput.h>
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+// Maps of increasing size, one per item
+std::vector<std::map<std::string, double>> maps()
+{
+    std::vector<std::map<std::string, double>> result(9);
+    for (size_t n = 0; n < result.size(); ++n)
+    {
+        for (size_t i = 0; i < n * n * 100; ++i)
+        {
+            result[n][std::to_string(i)] = static_cast<double>(i) / 8.0;
+        }
+    }
+    return result;
+}
+
+// Writes an object holding an array of maps, and a value after it, formatting the maps on several threads
+template <typename Writer, typename... Arguments>
+std::string writeDocument(unsigned threads, Arguments... arguments)
+{
+    std::vector<std::map<std::string, double>> const items = maps();
+    std::ostringstream                               out;
+    {
+        Writer writer(out, arguments...);
+        writer.beginObject(2);
+        writer.key("maps");
+        writer.beginArray(items.size());
+        writeItemsOrdered(writer,
+                          out,
+                          items.size(),
+                          threads,
+                          [&](Writer & itemWriter, size_t n)
+                          { writeSortedObject(itemWriter, items[n], [](Writer & w, double x) { w.value(x); }); });
+        writer.endArray();
+        writer.key("next");
+        writer.value(uint64_t(1));
+        writer.endObject();
+    }
+    return out.str();
+}
+
+} // anonymous namespace
+
+// ========== OrderedOutput Tests ==========
+
+TEST(OrderedOutputTest, SectionsAreWrittenInOrder)
+{
+    for (unsigned threads : {1u, 2u, 3u, 8u})
+    {
+        std::ostringstream out;
+        writeOrdered(out, 100, threads, [](size_t i, std::ostream & section) { section << std::string(i % 7, 'x') << i << ";"; });
+
+        std::ostringstream expected;
+        for (size_t i = 0; i < 100; ++i)
+        {
+            expected << std::string(i % 7, 'x') << i << ";";
+        }
+        EXPECT_EQ(out.str(), expected.str()) << threads << " threads";
+    }
+}
+
+TEST(OrderedOutputTest, NoSections)
+{
+    std::ostringstream out;
+    writeOrdered(out, 0, 4, [](size_t, std::ostream & section) { section << "x"; });
+    EXPECT_EQ(out.str(), "");
+}
+
+TEST(OrderedOutputTest, JsonItemsMatchNlohmann)
+{
+    nlohmann::json document;
+    document["maps"] = maps();
+    document["next"] = 1;
+    std::string const expected = document.dump(2);
+    for (unsigned threads : {1u, 2u, 4u})
+    {
+        EXPECT_EQ(writeDocument<JsonWriter>(threads), expected) << threads << " threads";
+    }
+}
+
+TEST(OrderedOutputTest, BinaryItemsMatchOneThread)
+{
+    for (BinaryFormat format : {BinaryFormat::Cbor, BinaryFormat::MessagePack})
+    {
+        std::string const expected = writeDocument<BinaryWriter>(1, format);
+        EXPECT_EQ(writeDocument<BinaryWriter>(4, format), expected);
+    }
+}
@@ -0,0 +1,136 @@
+#include <AliasTable.h>
+#include <NGramCounts.h>
+#include <NGramKey.h>
+#include <PseudoWordGenerator.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+// Counts of a few words
+NGramCounts sampleCounts()
+{
+    NGramCounts counts;
+    for (auto const & [word, weight] : WordList{{"the", 10.0}, {"queen", 2.0}, {"yellow", 3.0}, {"boat", 4.0},
+                                                {"strength", 1.0}, {"away", 2.0}})
+    {
+        counts.addWord(word, weight);
+    }
+    return counts;
+}
+
+} // anonymous namespace
+
+// ========== AliasTable Tests ==========
+
+TEST(AliasTableTest, SamplesInProportionToTheWeights)
+{
+    std::vector<double> const weights = {1.0, 0.0, 3.0, 6.0, 0.5, 9.5};
+    AliasTable                table(weights);
+    ASSERT_EQ(table.size(), weights.size());
+
+    std::mt19937_64     rng(1);
+    std::vector<size_t> hits(weights.size());
+    size_t const        samples = 200000;
+    for (size_t i = 0; i < samples; ++i)
+    {
+        ++hits[table.sample(rng())];
+    }
+
+    EXPECT_EQ(hits[1], 0u);
+    for (size_t i = 0; i < weights.size(); ++i)
+    {
+        double expected = samples * weights[i] / 20.0;
+        EXPECT_NEAR(static_cast<double>(hits[i]), expected, 5 * std::sqrt(expected) + 1) << "index " << i;
+    }
+}
+
+TEST(AliasTableTest, HandlesExtremeRandomNumbers)
+{
+    AliasTable table({1.0, 2.0, 3.0});
+    EXPECT_LT(table.sample(0), 3u);
+    EXPECT_LT(table.sample(~uint64_t(0)), 3u);
+}
+
+TEST(AliasTableTest, EmptyWithoutPositiveWeights)
+{
+    EXPECT_TRUE(AliasTable().empty());
+    EXPECT_TRUE(AliasTable({0.0, -1.0}).empty());
+    EXPECT_FALSE(AliasTable({0.0, 2.0}).empty());
+}
+
+// ========== PseudoWordGenerator Tests ==========
+
+TEST(PseudoWordGeneratorTest, WordLengthsFollowTheCounts)
+{
+    // Normalized lengths 3, 4, 6, 8 and 4 ("aWaY")
+    NGramCounts counts;
+    for (auto const & [word, weight] : WordList{{"the", 1.0}, {"boat", 1.0}, {"yellow", 1.0}, {"strength", 1.0}, {"away", 1.0}})
+    {
+        counts.addWord(word, weight);
+    }
+    PseudoWordGenerator generator = PseudoWordGenerator::build(counts, 3);
+    EXPECT_EQ(generator.order(), 3u);
+
+    std::vector<size_t> lengths(10);
+    for (auto const & word : generator.generate(5000, 2))
+    {
+        ++lengths[std::min<size_t>(replaceSpecialSequences(word).size(), 9)];
+    }
+    EXPECT_EQ(lengths[0] + lengths[1] + lengths[2] + lengths[5] + lengths[7] + lengths[9], 0u);
+    EXPECT_NEAR(lengths[4], 2000, 200);
+    EXPECT_NEAR(lengths[3], 1000, 150);
+}
+
+TEST(PseudoWordGeneratorTest, WordsUseOnlyCountedNGrams)
+{
+    // Words that normalization does not change, so the generated words can be checked as they are
+    NGramCounts counts;
+    for (auto const & [word, weight] : WordList{{"the", 3.0}, {"boat", 1.0}, {"strength", 2.0}, {"banana", 1.0}})
+    {
+        counts.addWord(word, weight);
+    }
+    PseudoWordGenerator generator = PseudoWordGenerator::build(counts, 2);
+
+    for (auto const & word : generator.generate(2000, 3))
+    {
+        std::string const & normalized = word;
+        for (size_t i = 0; i + 1 < normalized.size(); ++i)
+        {
+            // A bigram that was not counted can only follow a symbol that is never followed by anything
+            std::string bigram = normalized.substr(i, 2);
+            bool const  dead   = counts.ngramMaps[2].end() ==
+                               std::find_if(counts.ngramMaps[2].begin(), counts.ngramMaps[2].end(),
+                                            [&](auto const & entry) { return entry.first[0] == bigram[0]; });
+            EXPECT_TRUE(counts.ngramMaps[2].count(bigram) != 0 || dead) << word;
+        }
+    }
+}
+
+TEST(PseudoWordGeneratorTest, OutputDependsOnlyOnTheSeed)
+{
+    PseudoWordGenerator      generator = PseudoWordGenerator::build(sampleCounts(), 3);
+    std::vector<std::string> reference = generator.generate(10000, 42, 1);
+    ASSERT_EQ(reference.size(), 10000u);
+    for (unsigned threads : {2u, 3u, 8u})
+    {
+        EXPECT_EQ(generator.generate(10000, 42, threads), reference) << threads << " threads";
+    }
+    EXPECT_NE(generator.generate(10000, 43, 1), reference);
+    EXPECT_TRUE(generator.generate(0, 42, 4).empty());
+}
+
+TEST(PseudoWordGeneratorTest, InvalidArguments)
+{
+    EXPECT_THROW(PseudoWordGenerator::build(sampleCounts(), 0), std::invalid_argument);
+    EXPECT_THROW(PseudoWordGenerator::build(sampleCounts(), MAX_PACKED_NGRAM_LENGTH + 1), std::invalid_argument);
+    EXPECT_THROW(PseudoWordGenerator::build(NGramCounts(), 2), std::invalid_argument);
+    EXPECT_EQ(PseudoWordGenerator::build(sampleCounts(), 12).order(), 8u);
+}
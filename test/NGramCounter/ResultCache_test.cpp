@@ -0,0 +1,109 @@
+#include <ResultCache.h>
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace fs = std::filesystem;
+
+// Test fixture providing an input file and a cache directory that are removed after each test
+class ResultCacheTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        directory = (fs::temp_directory_path() / "test_result_cache").string();
+        inputPath = (fs::temp_directory_path() / "test_result_cache_input.csv").string();
+        writeInput("Word,SUBTLWF\nthe,100\n");
+    }
+
+    void TearDown() override
+    {
+        fs::remove_all(directory);
+        fs::remove(inputPath);
+    }
+
+    void writeInput(std::string const & contents)
+    {
+        std::ofstream out(inputPath, std::ios::binary | std::ios::trunc);
+        out << contents;
+    }
+
+    std::string directory;
+    std::string inputPath;
+};
+
+TEST_F(ResultCacheTest, FingerprintDependsOnEveryByte)
+{
+    std::string data(1000, 'a');
+    uint64_t    reference = fingerprint(data);
+    EXPECT_EQ(fingerprint(data), reference);
+    for (size_t i : {0u, 7u, 8u, 500u, 999u})
+    {
+        std::string changed = data;
+        changed[i]          = 'b';
+        EXPECT_NE(fingerprint(changed), reference) << i;
+    }
+    EXPECT_NE(fingerprint(data.substr(0, 999)), reference);
+    EXPECT_NE(fingerprint(data + '\0'), reference);
+    EXPECT_NE(fingerprint(""), fingerprint(std::string(1, '\0')));
+}
+
+TEST_F(ResultCacheTest, FingerprintFileMatchesContents)
+{
+    // Larger than one read block, and not a multiple of 8 bytes
+    std::string contents;
+    for (int i = 0; contents.size() < (size_t(3) << 19) + 5; ++i)
+    {
+        contents += std::to_string(i * 7919) + ",";
+    }
+    writeInput(contents);
+    EXPECT_EQ(fingerprintFile(inputPath), fingerprint(contents));
+    EXPECT_THROW(fingerprintFile(directory + "/missing"), std::runtime_error);
+}
+
+TEST_F(ResultCacheTest, StoreLoadRoundTrip)
+{
+    ResultCache cache(directory, inputPath, "min-weight=0");
+    EXPECT_FALSE(cache.load().has_value());
+
+    Checkpoint state;
+    state.counts.addWord("cache", 2.5);
+    state.position        = 1;
+    state.processedWeight = 2.5;
+    state.inputWords      = 1;
+    state.inputWeight     = 2.5;
+    cache.store(state);
+
+    auto loaded = ResultCache(directory, inputPath, "min-weight=0").load();
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_EQ(loaded->position, 1u);
+    EXPECT_EQ(loaded->inputWeight, 2.5);
+    EXPECT_EQ(loaded->counts.ngramMaps, state.counts.ngramMaps);
+    EXPECT_EQ(loaded->counts.totalWeights, state.counts.totalWeights);
+}
+
+TEST_F(ResultCacheTest, KeyCoversInputAndOptions)
+{
+    ResultCache cache(directory, inputPath, "min-weight=0");
+    cache.store(Checkpoint());
+
+    EXPECT_NE(ResultCache(directory, inputPath, "min-weight=1").path(), cache.path());
+    EXPECT_FALSE(ResultCache(directory, inputPath, "min-weight=1").load().has_value());
+
+    writeInput("Word,SUBTLWF\nthe,101\n");
+    EXPECT_NE(ResultCache(directory, inputPath, "min-weight=0").path(), cache.path());
+    EXPECT_FALSE(ResultCache(directory, inputPath, "min-weight=0").load().has_value());
+}
+
+TEST_F(ResultCacheTest, InvalidEntryIsIgnored)
+{
+    ResultCache cache(directory, inputPath, "");
+    fs::create_directories(directory);
+    std::ofstream(cache.path(), std::ios::binary) << "garbage";
+    EXPECT_FALSE(cache.load().has_value());
+
+    cache.store(Checkpoint());
+    EXPECT_TRUE(cache.load().has_value());
+}
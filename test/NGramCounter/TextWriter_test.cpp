@@ -0,0 +1,90 @@
+#include <TextWriter.h>
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// ========== TextWriter Tests ==========
+
+TEST(TextWriterTest, DoublesMatchOstream)
+{
+    std::vector<double> values = {0.0,
+                                  -0.0,
+                                  1.0,
+                                  -2.5,
+                                  100.0,
+                                  123456.0,
+                                  1234567.0,
+                                  0.0001,
+                                  0.00001,
+                                  1.0 / 3.0,
+                                  999999.5,
+                                  9.999995,
+                                  1e300,
+                                  -1e-300,
+                                  std::numeric_limits<double>::min(),
+                                  std::numeric_limits<double>::denorm_min(),
+                                  std::numeric_limits<double>::max(),
+                                  std::numeric_limits<double>::infinity(),
+                                  -std::numeric_limits<double>::infinity()};
+    std::mt19937_64 random(42);
+    for (int i = 0; i < 10000; ++i)
+    {
+        values.push_back(std::ldexp(std::uniform_real_distribution<double>(-1.0, 1.0)(random), static_cast<int>(random() % 200) - 100));
+    }
+
+    for (double x : values)
+    {
+        std::ostringstream expected;
+        expected << x;
+        std::ostringstream out;
+        {
+            TextWriter writer(out);
+            writer << x;
+        }
+        EXPECT_EQ(out.str(), expected.str());
+    }
+}
+
+TEST(TextWriterTest, IntegersMatchOstream)
+{
+    std::ostringstream expected;
+    std::ostringstream out;
+    {
+        TextWriter writer(out);
+        for (auto x : {std::numeric_limits<int64_t>::min(), int64_t(-1), int64_t(0), std::numeric_limits<int64_t>::max()})
+        {
+            expected << x << ' ';
+            writer << x << ' ';
+        }
+        expected << std::numeric_limits<uint64_t>::max() << std::numeric_limits<int>::min() << 42u << size_t(7);
+        writer << std::numeric_limits<uint64_t>::max() << std::numeric_limits<int>::min() << 42u << size_t(7);
+    }
+    EXPECT_EQ(out.str(), expected.str());
+}
+
+TEST(TextWriterTest, TextIsWrittenInBlocks)
+{
+    std::ostringstream out;
+    std::string        expected;
+    {
+        TextWriter writer(out, 64);
+        for (int i = 0; i < 1000; ++i)
+        {
+            writer << "word " << std::string("x") << '\t' << i << ' ' << i / 8.0 << '\n';
+            expected += "word x\t" + std::to_string(i) + ' ';
+            std::ostringstream number;
+            number << i / 8.0;
+            expected += number.str() + '\n';
+        }
+        EXPECT_LE(expected.size() - out.str().size(), 64u);
+        writer.flush();
+        EXPECT_EQ(out.str(), expected);
+    }
+    EXPECT_EQ(out.str(), expected);
+}
@@ -0,0 +1,19 @@
+#include <NGramCounts.h>
+#include <WordArena.h>
+#include <gtest/gtest.h>
+
+#include <string>
+
+// ========== WordArena Tests ==========
+
+TEST(WordArenaTest, StoresWordsInOrder)
+{
+    WordList  words = {{"the", 1.0}, {"", 2.0}, {"quick", 3.0}};
+    WordArena arena(words);
+    ASSERT_EQ(arena.size(), 3u);
+    EXPECT_EQ(arena[0], "the");
+    EXPECT_EQ(arena[1], "");
+    EXPECT_EQ(arena[2], "quick");
+    EXPECT_EQ(arena.bytes(), std::string("the\0\0quick\0", 11));
+}
+
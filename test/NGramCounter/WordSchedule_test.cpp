@@ -0,0 +1,119 @@
+#include <NGramCounter.h>
+#include <NGramCounts.h>
+#include <RandomWords.h>
+#include <WordSchedule.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// ========== normalizedLength() Tests ==========
+
+TEST(WordScheduleTest, NormalizedLengthMatchesReplaceSpecialSequences)
+{
+    for (std::string word : {"queen", "quay", "play", "yes", "ayy", "law", "qu", "q", "quququ", "qy", "don't", ""})
+    {
+        EXPECT_EQ(normalizedLength(word), replaceSpecialSequences(word).size()) << word;
+    }
+    for (auto const & [word, weight] : randomWords(1, 1000, "equywaoxt", 12, 0.25))
+    {
+        EXPECT_EQ(normalizedLength(word), replaceSpecialSequences(word).size()) << word;
+    }
+}
+
+// ========== scheduleWords() Tests ==========
+
+TEST(WordScheduleTest, BucketsByNormalizedLengthInRangeOrder)
+{
+    WordList const     words    = randomWords(2, 2000, "equywaoxt", 12, 0.25);
+    WordSchedule const schedule = scheduleWords(words, 100, 1900, 64);
+
+    // The order is a permutation of the range, sorted by normalized length, and in range order within a length
+    ASSERT_EQ(schedule.order.size(), 1800u);
+    std::vector<size_t> expected(1800);
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        expected[i] = 100 + i;
+    }
+    std::stable_sort(expected.begin(),
+                     expected.end(),
+                     [&](size_t a, size_t b)
+                     { return normalizedLength(words[a].first) < normalizedLength(words[b].first); });
+    EXPECT_EQ(schedule.order, expected);
+
+    // The blocks cover the order in sequence, each with words of its length and no more characters than the limit
+    size_t next = 0;
+    for (auto const & block : schedule.blocks)
+    {
+        EXPECT_EQ(block.begin, next);
+        EXPECT_LT(block.begin, block.end);
+        size_t characters = 0;
+        for (size_t i = block.begin; i < block.end; ++i)
+        {
+            EXPECT_EQ(normalizedLength(words[schedule.order[i]].first), block.length);
+            characters += words[schedule.order[i]].first.size();
+        }
+        EXPECT_LE(characters, 64u);
+        next = block.end;
+    }
+    EXPECT_EQ(next, schedule.order.size());
+}
+
+TEST(WordScheduleTest, BlockHoldsAtLeastOneWord)
+{
+    WordList const     words    = {{"abcdef", 1.0}, {"ghijkl", 1.0}, {"", 1.0}};
+    WordSchedule const schedule = scheduleWords(words, 0, words.size(), 4);
+    ASSERT_EQ(schedule.blocks.size(), 3u);
+    EXPECT_EQ(schedule.order, (std::vector<size_t>{2, 0, 1}));
+    EXPECT_TRUE(scheduleWords(words, 1, 1).blocks.empty());
+}
+
+TEST(WordScheduleTest, ScheduledCountsMatchAddWord)
+{
+    WordList const words = randomWords(3, 3000, "equywaoxt", 12, 0.25);
+    NGramCounts    expected;
+    for (auto const & [word, weight] : words)
+    {
+        expected.addWord(word, weight);
+    }
+
+    // The weights are multiples of 1/4, so every order sums them exactly
+    for (unsigned threads : {1u, 3u})
+    {
+        CountingOptions options;
+        options.threads = threads;
+        NGramCounts counts;
+        countNGrams(counts, words, 0, words.size(), options);
+        EXPECT_EQ(counts.ngramMaps, expected.ngramMaps) << threads << " threads";
+        EXPECT_EQ(counts.totalWeights, expected.totalWeights) << threads << " threads";
+    }
+}
+
+// ========== Length Partition Tests ==========
+
+TEST(LengthPartitionTest, CountsMatchAddWordExactlyForAnyThreadCount)
+{
+    // Each n-gram is added in word order, as by addWord(), so even weights that are not summed exactly give equal results
+    WordList words = randomWords(4, 3000, "equywaoxt", 12, 0.25);
+    for (size_t i = 0; i < words.size(); ++i)
+    {
+        words[i].second = 0.1 * static_cast<double>(1 + i % 7);
+    }
+    NGramCounts expected;
+    for (auto const & [word, weight] : words)
+    {
+        expected.addWord(word, weight);
+    }
+
+    for (unsigned threads : {1u, 2u, 5u, 64u})
+    {
+        CountingOptions options;
+        options.threads     = threads;
+        options.parallelism = Parallelism::Lengths;
+        NGramCounts counts;
+        countNGrams(counts, words, 0, words.size(), options);
+        EXPECT_EQ(counts.ngramMaps, expected.ngramMaps) << threads << " threads";
+        EXPECT_EQ(counts.totalWeights, expected.totalWeights) << threads << " threads";
+    }
+}
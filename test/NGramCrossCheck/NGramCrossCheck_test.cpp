@@ -0,0 +1,395 @@
+// Differential tests that check every counting engine, at several thread counts, against a reference implementation of the
+// original ngram_analyzer counting loop.
+
+#include <NGramCounter.h>
+#include <NGramCounts.h>
+#include <PipelinedCounter.h>
+#include <RandomWords.h>
+#include <SubtlexImporter.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+// Maximum relative difference allowed between a count and the reference count. Engines may add weights in a different
+// order, so the counts are not expected to be bit-for-bit identical.
+double const TOLERANCE = 1e-9;
+
+// Thread counts to test each engine with
+std::vector<unsigned> const THREAD_COUNTS = {1, 2, 3, 8};
+
+// Results of the reference implementation
+struct ReferenceResult
+{
+    std::vector<NGramMap> ngramMaps;
+    std::vector<double>   totalWeights;
+    NGramMap              vowelNgrams;
+    NGramMap              consonantNgrams;
+};
+
+// A copy of the original replaceSpecialSequences(), kept independent of the library so that changes to the library's
+// normalization are caught too.
+std::string referenceReplaceSpecialSequences(std::string const & input)
+{
+    std::string_view const CONSONANTS = "tnhsrldymwgcfbpkvjxzqQ";
+
+    std::string result;
+    result.reserve(input.size());
+
+    size_t i = 0;
+    while (i < input.size())
+    {
+        char c0 = input[i++];
+        result.push_back(c0);
+        if (i < input.size())
+        {
+            char c1 = input[i];
+            if (c1 == 'y')
+            {
+                if (c0 == 'a' || c0 == 'e' || c0 == 'o' || c0 == 'u' || CONSONANTS.find(c0) != std::string_view::npos)
+                {
+                    result.push_back('Y');
+                    ++i;
+                }
+            }
+            else if (c1 == 'w')
+            {
+                if (c0 == 'a' || c0 == 'e' || c0 == 'o')
+                {
+                    result.push_back('W');
+                    ++i;
+                }
+            }
+            if (c0 == 'q')
+            {
+                if (c1 == 'u')
+                {
+                    result.back() = 'Q';
+                    ++i;
+                }
+            }
+        }
+    }
+    return result;
+}
+
+// A copy of the original counting loop and vowel/consonant extraction in ngram_analyzer
+ReferenceResult referenceCount(WordList const & words)
+{
+    std::string_view const VOWELS     = "eoaiuYW";
+    std::string_view const CONSONANTS = "tnhsrldymwgcfbpkvjxzqQ";
+
+    ReferenceResult result;
+    auto &          ngramMaps    = result.ngramMaps;
+    auto &          totalWeights = result.totalWeights;
+    for (auto const & [word, weight] : words)
+    {
+        size_t wordLength = word.length();
+        if (ngramMaps.size() < wordLength + 1)
+        {
+            ngramMaps.resize(wordLength + 1);
+            totalWeights.resize(wordLength + 1, 0);
+        }
+        std::string_view wordView = word;
+        for (size_t n = 1; n <= wordLength; ++n)
+        {
+            for (size_t i = 0; i <= wordLength - n; ++i)
+            {
+                std::string ngram = std::string(wordView.substr(i, n));
+                ngram             = referenceReplaceSpecialSequences(ngram);
+                size_t ngramSize  = ngram.size();
+                auto & counts     = ngramMaps[ngramSize];
+                counts[std::string(ngram)] += weight;
+                totalWeights[ngramSize] += weight;
+            }
+        }
+    }
+
+    for (auto const & ngram_map : ngramMaps)
+    {
+        for (auto const & [ngram, weight] : ngram_map)
+        {
+            if (ngram.find_first_not_of(VOWELS) == std::string_view::npos)
+            {
+                result.vowelNgrams[ngram] = weight;
+            }
+            else if (ngram.find_first_not_of(CONSONANTS) == std::string_view::npos)
+            {
+                result.consonantNgrams[ngram] = weight;
+            }
+        }
+    }
+    return result;
+}
+
+// Returns the reference result without the n-grams lighter than minWeight. The total weights are unchanged.
+//
+// Weights summed in different orders differ by rounding errors, so an n-gram is kept if its reference weight is at least
+// minWeight less MIN_WEIGHT_TOLERANCE times minWeight, the tolerance of every engine's comparison. Thresholds at which
+// weights land exactly on the threshold then keep the same n-grams in every configuration.
+ReferenceResult referenceThresholded(ReferenceResult reference, double minWeight)
+{
+    double const lowest = minWeight * (1.0 - MIN_WEIGHT_TOLERANCE);
+    auto         prune  = [lowest](NGramMap & map)
+    {
+        for (auto it = map.begin(); it != map.end();)
+        {
+            it = (it->second < lowest) ? map.erase(it) : std::next(it);
+        }
+    };
+    for (auto & map : reference.ngramMaps)
+    {
+        prune(map);
+    }
+    prune(reference.vowelNgrams);
+    prune(reference.consonantNgrams);
+    return reference;
+}
+
+// Words and weights loaded from the bundled SUBTLEX file, in the order used by ngram_analyzer
+WordList const & subtlexWords()
+{
+    static WordList const words = []
+    {
+        SubtlexImporter importer(SUBTLEX_PATH);
+        WordList        result;
+        for (auto const & [word, value] : importer.get("SUBTLWF"))
+        {
+            result.emplace_back(word, std::get<double>(value));
+        }
+        std::sort(result.begin(),
+                  result.end(),
+                  [](auto const & a, auto const & b)
+                  { return (a.second != b.second) ? b.second < a.second : a.first < b.first; });
+        return result;
+    }();
+    return words;
+}
+
+ReferenceResult const & subtlexReference()
+{
+    static ReferenceResult const reference = referenceCount(subtlexWords());
+    return reference;
+}
+
+// Generates random words. The letters that take part in special sequences are over-represented so that the sequences
+// (and their overlaps, such as "quy" or "ayy") occur often. Every seventh word may also contain characters outside the
+// normalized alphabet, so that the engines' paths for words that cannot be packed are checked too. The weights are
+// multiples of 0.7, which are not summed exactly, and many n-gram weights reach the thresholds of the tests exactly.
+WordList randomCrossCheckWords(unsigned seed, size_t count, size_t maxLength)
+{
+    return randomWords(seed, count, "abcdefghijklmnopqrstuvwxyzqquuyyyywwwaeo", maxLength, 0.7, "'I");
+}
+
+bool isNear(double actual, double expected)
+{
+    return std::abs(actual - expected) <= TOLERANCE * std::max(std::abs(expected), 1.0);
+}
+
+// Checks that two maps have the same n-grams with weights within the tolerance, reporting only the first few differences
+void expectMapsNear(NGramMap const & actual, NGramMap const & expected, std::string const & what)
+{
+    EXPECT_EQ(actual.size(), expected.size()) << what;
+    int reported = 0;
+    for (auto const & [ngram, weight] : expected)
+    {
+        auto it = actual.find(ngram);
+        if (it == actual.end() || !isNear(it->second, weight))
+        {
+            ADD_FAILURE() << what << ": n-gram '" << ngram << "' expected " << weight << ", got "
+                          << ((it == actual.end()) ? std::string("nothing") : std::to_string(it->second));
+            if (++reported == 5)
+            {
+                return;
+            }
+        }
+    }
+}
+
+void expectMatchesReference(NGramCounts const & counts, ReferenceResult const & reference)
+{
+    size_t lengths = std::max(counts.ngramMaps.size(), reference.ngramMaps.size());
+    for (size_t n = 0; n < lengths; ++n)
+    {
+        NGramMap const empty;
+        auto const &   actual   = (n < counts.ngramMaps.size()) ? counts.ngramMaps[n] : empty;
+        auto const &   expected = (n < reference.ngramMaps.size()) ? reference.ngramMaps[n] : empty;
+        expectMapsNear(actual, expected, std::to_string(n) + "-grams");
+
+        double actualTotal   = (n < counts.totalWeights.size()) ? counts.totalWeights[n] : 0.0;
+        double expectedTotal = (n < reference.totalWeights.size()) ? reference.totalWeights[n] : 0.0;
+        EXPECT_TRUE(isNear(actualTotal, expectedTotal))
+            << "total weight of " << n << "-grams: expected " << expectedTotal << ", got " << actualTotal;
+    }
+
+    VowelConsonantNGrams classNgrams = extractVowelConsonantNGrams(counts);
+    expectMapsNear(classNgrams.vowels, reference.vowelNgrams, "vowel n-grams");
+    expectMapsNear(classNgrams.consonants, reference.consonantNgrams, "consonant n-grams");
+}
+
+// Returns every combination of engine and thread count, and the hash engine partitioned by length
+std::vector<CountingOptions> allConfigurations()
+{
+    std::vector<CountingOptions> configurations;
+    for (CountingEngine engine : countingEngines())
+    {
+        for (unsigned threads : THREAD_COUNTS)
+        {
+            CountingOptions options;
+            options.engine  = engine;
+            options.threads = threads;
+            configurations.push_back(options);
+        }
+    }
+    for (unsigned threads : THREAD_COUNTS)
+    {
+        CountingOptions options;
+        options.threads     = threads;
+        options.parallelism = Parallelism::Lengths;
+        configurations.push_back(options);
+    }
+    return configurations;
+}
+
+std::string configurationName(::testing::TestParamInfo<CountingOptions> const & info)
+{
+    std::ostringstream name;
+    name << countingEngineName(info.param.engine) << "_";
+    if (info.param.parallelism == Parallelism::Lengths)
+    {
+        name << "lengths_";
+    }
+    name << info.param.threads << "threads";
+    return name.str();
+}
+
+} // anonymous namespace
+
+// Prints the test parameter in test names and failure messages
+void PrintTo(CountingOptions const & options, std::ostream * os)
+{
+    *os << countingEngineName(options.engine) << " engine, " << options.threads << " thread(s)";
+    if (options.parallelism == Parallelism::Lengths)
+    {
+        *os << " owning lengths";
+    }
+}
+
+// Test fixture parameterized by engine and thread count
+class NGramCrossCheckTest : public ::testing::TestWithParam<CountingOptions>
+{
+};
+
+TEST_P(NGramCrossCheckTest, RandomWordsMatchReference)
+{
+    for (unsigned seed = 1; seed <= 5; ++seed)
+    {
+        SCOPED_TRACE("seed " + std::to_string(seed));
+        WordList    words = randomCrossCheckWords(seed, 2000, 24);
+        NGramCounts counts;
+        countNGrams(counts, words, 0, words.size(), GetParam());
+        expectMatchesReference(counts, referenceCount(words));
+    }
+}
+
+TEST_P(NGramCrossCheckTest, ChunkedCountingMatchesReference)
+{
+    // Counting a word list in several calls (as done between checkpoints) gives the same result as counting it at once
+    WordList    words = randomCrossCheckWords(42, 1000, 16);
+    NGramCounts counts;
+    for (size_t begin = 0; begin < words.size(); begin += 137)
+    {
+        countNGrams(counts, words, begin, std::min(begin + 137, words.size()), GetParam());
+    }
+    expectMatchesReference(counts, referenceCount(words));
+}
+
+TEST_P(NGramCrossCheckTest, RandomWordsThresholdedMatchReference)
+{
+    CountingOptions options = GetParam();
+    for (double minWeight : {1.4, 49.0, 490.0})
+    {
+        SCOPED_TRACE("minimum weight " + std::to_string(minWeight));
+        options.minWeight = minWeight;
+
+        WordList    words = randomCrossCheckWords(11, 3000, 20);
+        NGramCounts counts;
+        countNGrams(counts, words, 0, words.size(), options);
+        expectMatchesReference(counts, referenceThresholded(referenceCount(words), minWeight));
+    }
+}
+
+TEST_P(NGramCrossCheckTest, PipelinedCountingMatchesReference)
+{
+    // Small batches and a short queue make the producer wait on the counting threads
+    CountingOptions options = GetParam();
+    for (double minWeight : {0.0, 49.0})
+    {
+        SCOPED_TRACE("minimum weight " + std::to_string(minWeight));
+        options.minWeight = minWeight;
+
+        WordList         words = randomCrossCheckWords(7, 2000, 20);
+        PipelinedCounter counter(options, 37, 2);
+        for (auto const & [word, weight] : words)
+        {
+            counter.add(word, weight);
+        }
+        EXPECT_EQ(counter.words(), words.size());
+        expectMatchesReference(counter.finish(), referenceThresholded(referenceCount(words), minWeight));
+    }
+}
+
+TEST_P(NGramCrossCheckTest, EmptyRangeCountsNothing)
+{
+    WordList    words = randomCrossCheckWords(7, 10, 8);
+    NGramCounts counts;
+    countNGrams(counts, words, 5, 5, GetParam());
+    expectMatchesReference(counts, ReferenceResult{});
+}
+
+INSTANTIATE_TEST_SUITE_P(AllEngines, NGramCrossCheckTest, ::testing::ValuesIn(allConfigurations()), configurationName);
+
+// The reference result for the SUBTLEX file takes a while to compute, so every configuration is checked against it in one
+// test.
+TEST(NGramCrossCheckSubtlexTest, AllEnginesMatchReference)
+{
+    WordList const & words = subtlexWords();
+    for (CountingOptions options : allConfigurations())
+    {
+        for (double minWeight : {0.0, 100.0})
+        {
+            SCOPED_TRACE(::testing::PrintToString(options) + ", minimum weight " + std::to_string(minWeight));
+            options.minWeight = minWeight;
+
+            NGramCounts counts;
+            countNGrams(counts, words, 0, words.size(), options);
+            expectMatchesReference(counts, referenceThresholded(subtlexReference(), minWeight));
+        }
+    }
+}
+
+// Many SUBTLEX weights are multiples of 0.01, so many n-gram weights sum to exactly 0.5, in an order that depends on the
+// engine and the thread count. Every configuration must keep the same n-grams as the reference at that threshold.
+TEST(NGramCrossCheckSubtlexTest, AllEnginesKeepTheSameNGramsAtABoundaryThreshold)
+{
+    double const          minWeight = 0.5;
+    WordList const &      words     = subtlexWords();
+    ReferenceResult const reference = referenceThresholded(subtlexReference(), minWeight);
+    for (CountingOptions options : allConfigurations())
+    {
+        SCOPED_TRACE(::testing::PrintToString(options));
+        options.minWeight = minWeight;
+
+        NGramCounts counts;
+        countNGrams(counts, words, 0, words.size(), options);
+        expectMatchesReference(counts, reference);
+    }
+}
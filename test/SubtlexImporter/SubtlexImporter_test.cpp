@@ -6,7 +6,10 @@
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <variant>
+#include <vector>
 
 namespace fs = std::filesystem;
 
@@ -739,6 +742,60 @@ TEST_F(SubtlexImporterTest, ValidAlphabeticWordsOnlyAccepted)
     EXPECT_EQ(result.size(), 3);
 }
 
+// ========== forEach() Tests ==========
+
+TEST_F(SubtlexImporterTest, ForEachVisitsRowsInFileOrder)
+{
+    TempCSVFile tempFile(validCSV());
+
+    std::vector<std::pair<std::string, double>> rows;
+    SubtlexImporter::forEach(tempFile.path(),
+                             "SUBTLWF",
+                             [&rows](std::string const & word, DatasetImporter::Value const & value)
+                             { rows.emplace_back(word, std::get<double>(value)); });
+
+    std::vector<std::pair<std::string, double>> expected = {{"apple", 1.5}, {"banana", 2.8}, {"cherry", 0.9}};
+    EXPECT_EQ(rows, expected);
+}
+
+TEST_F(SubtlexImporterTest, ForEachMatchesGet)
+{
+    TempCSVFile     tempFile(validCSV());
+    SubtlexImporter importer(tempFile.path());
+
+    for (std::string column : {"Word", "FREQcount", "Zipf-value", "All_PoS_SUBTLEX"})
+    {
+        std::unordered_map<std::string, DatasetImporter::Value> visited;
+        SubtlexImporter::forEach(tempFile.path(),
+                                 column,
+                                 [&visited](std::string const & word, DatasetImporter::Value const & value)
+                                 { visited.emplace(word, value); });
+        EXPECT_EQ(visited, importer.get(column)) << column;
+    }
+}
+
+TEST_F(SubtlexImporterTest, ForEachInvalidColumnVisitsNothing)
+{
+    TempCSVFile tempFile(validCSV());
+
+    int visits = 0;
+    SubtlexImporter::forEach(tempFile.path(), "NonExistentColumn", [&visits](auto const &, auto const &) { ++visits; });
+    EXPECT_EQ(visits, 0);
+}
+
+TEST_F(SubtlexImporterTest, ForEachValidatesTheFile)
+{
+    std::ostringstream oss;
+    oss << validHeader() << "\n";
+    oss << "apple,100,50,80,40,1.5,0.176,2.3,0.362,noun,90,0.9,noun,90,3.5\n";
+    oss << "Apple,100,50,80,40,1.5,0.176,2.3,0.362,noun,90,0.9,noun,90,3.5\n"; // Duplicate "apple"
+    TempCSVFile tempFile(oss.str());
+
+    auto ignore = [](std::string const &, DatasetImporter::Value const &) {};
+    EXPECT_THROW(SubtlexImporter::forEach(tempFile.path(), "SUBTLWF", ignore), std::runtime_error);
+    EXPECT_THROW(SubtlexImporter::forEach("non_existent_file.csv", "SUBTLWF", ignore), std::runtime_error);
+}
+
 // ========== Main function ==========
 
 int main(int argc, char ** argv)
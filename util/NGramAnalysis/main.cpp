@@ -2,234 +2,816 @@
 //
 // A C++ program to perform N - gram analysis on a dictionary.
 
+#include <Alphabet.h>
+#include <BinaryWriter.h>
 #include <CLI/CLI.hpp>
+#include <Checkpoint.h>
+#include <DocumentFrequency.h>
+#include <EngineSelection.h>
+#include <JsonWriter.h>
+#include <LanguageModel.h>
+#include <NGramCounter.h>
+#include <NGramCounts.h>
+#include <NGramIndex.h>
+#include <NGramStatistics.h>
+#include <OrderedOutput.h>
+#include <PipelinedCounter.h>
+#include <PseudoWordGenerator.h>
+#include <ResultCache.h>
 #include <SubtlexImporter.h>
-#include <nlohmann/json.hpp>
+#include <TextWriter.h>
 
 #include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
 #include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <optional>
+#include <sstream>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
-using json = nlohmann::json;
-
-typedef std::unordered_map<std::string, double>                    NGramMap;
 typedef std::vector<std::pair<std::string_view, std::string_view>> ReplacementList;
 
 namespace
 {
 
-// Vowels in order of frequency in English, 'Y' and 'W' represent 'y' and 'w' as vowels
-std::string_view const VOWELS = "eoaiuYW";
-// Consonants in order of frequency in English, 'Q' represents 'qu'
-std::string_view const CONSONANTS = "tnhsrldymwgcfbpkvjxzqQ";
-// Replace certain character sequences with special characters for analysis
-std::string replaceSpecialSequences(std::string const & input);
+// Number of words read and scored at a time
+size_t const SCORE_BATCH_SIZE = 65536;
+
+// Prints each word of a file (one per line, or standard input if the path is "-") followed by a tab and its log2 probability.
+// Words are converted to lowercase, like the SUBTLEX words. The words are read and scored in batches, and each batch is
+// printed as soon as it is scored, so the output streams while the input is being read. Returns the exit code.
+int scoreWords(LanguageModel const & model, std::string const & path, unsigned threads)
+{
+    std::ifstream file;
+    if (path != "-")
+    {
+        file.open(path);
+        if (!file.is_open())
+        {
+            std::cerr << "Cannot open file: " << path << std::endl;
+            return 1;
+        }
+    }
+    std::istream & in = (path != "-") ? file : std::cin;
+
+    std::vector<std::string>      words;
+    std::vector<std::string_view> batch;
+    std::string                   line;
+    TextWriter                    out(std::cout);
+    while (in)
+    {
+        words.clear();
+        while (words.size() < SCORE_BATCH_SIZE && std::getline(in, line))
+        {
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.pop_back();
+            }
+            std::transform(line.begin(), line.end(), line.begin(), [](char x) { return static_cast<char>(::tolower(x)); });
+            words.push_back(std::move(line));
+        }
+
+        batch.assign(words.begin(), words.end());
+        std::vector<double> scores = model.scoreBatch(batch, threads);
+        for (size_t i = 0; i < words.size(); ++i)
+        {
+            out << words[i] << '\t' << scores[i] << '\n';
+        }
+        out.flush();
+    }
+    std::cout.flush();
+    return 0;
+}
+
+// Parses a size in bytes with an optional K, M or G suffix (powers of 1024), optionally followed by B or iB. Returns 0 if
+// the size is not a positive number.
+double parseByteSize(std::string const & text)
+{
+    double value = 0.0;
+    size_t used  = 0;
+    try
+    {
+        value = std::stod(text, &used);
+    }
+    catch (std::exception const &)
+    {
+        return 0.0;
+    }
+
+    std::string suffix = text.substr(used);
+    std::transform(
+        suffix.begin(), suffix.end(), suffix.begin(), [](char x) { return static_cast<char>(::toupper(x)); });
+    double scale = 1.0;
+    if (!suffix.empty() && std::string_view("KMG").find(suffix[0]) != std::string_view::npos)
+    {
+        scale  = std::ldexp(1.0, 10 * (1 + static_cast<int>(std::string_view("KMG").find(suffix[0]))));
+        suffix = suffix.substr(1);
+    }
+    if (!suffix.empty() && suffix != "B" && !(scale > 1.0 && suffix == "IB"))
+    {
+        return 0.0;
+    }
+    return (value > 0.0) ? value * scale : 0.0;
+}
+
+// Formats a size in bytes in MiB
+std::string formatMebibytes(double bytes)
+{
+    std::ostringstream out;
+    out.setf(std::ios::fixed);
+    out.precision(1);
+    out << bytes / (1024.0 * 1024.0) << " MiB";
+    return out.str();
+}
+
+// The results reported by --json and --format
+struct Results
+{
+    std::vector<NGramMap> const &             ngramMaps;           // Counts of each length
+    VowelConsonantNGrams const &              classNgrams;         // Vowel-only and consonant-only n-grams
+    double const *                            coverage;            // Fraction of the weight counted, or nullptr
+    std::vector<DocumentFrequencyMap> const * documentFrequencies; // Document frequencies, or nullptr
+    std::vector<NGramStatistics> const *      statistics;          // Statistics of each length, or nullptr
+};
+
+// Writes the results with a JsonWriter or a BinaryWriter writing to a stream. The members of each object are written in
+// the order of their keys, as nlohmann::json orders them. The maps of each length are formatted on several threads.
+template <typename Writer>
+void writeResults(Writer & writer, std::ostream & out, Results const & results, unsigned threads)
+{
+    auto const writeWeight = [](Writer & w, double weight) { w.value(weight); };
+
+    writer.beginObject(3 + (results.coverage != nullptr) + (results.documentFrequencies != nullptr) +
+                       (results.statistics != nullptr));
+    writer.key("consonants");
+    writeSortedObject(writer, results.classNgrams.consonants, writeWeight);
+    if (results.coverage != nullptr)
+    {
+        writer.key("coverage");
+        writer.value(*results.coverage);
+    }
+    if (results.documentFrequencies != nullptr)
+    {
+        writer.key("document_frequencies");
+        writer.beginArray(results.documentFrequencies->size());
+        writeItemsOrdered(writer,
+                          out,
+                          results.documentFrequencies->size(),
+                          threads,
+                          [&](Writer & itemWriter, size_t n)
+                          {
+                              writeSortedObject(itemWriter,
+                                                (*results.documentFrequencies)[n],
+                                                [](Writer & w, DocumentFrequency const & frequency)
+                                                {
+                                                    w.beginObject(2);
+                                                    w.key("weight");
+                                                    w.value(frequency.weight);
+                                                    w.key("words");
+                                                    w.value(frequency.words);
+                                                    w.endObject();
+                                                });
+                          });
+        writer.endArray();
+    }
+    writer.key("ngrams");
+    writer.beginArray(results.ngramMaps.size());
+    writeItemsOrdered(writer,
+                      out,
+                      results.ngramMaps.size(),
+                      threads,
+                      [&](Writer & itemWriter, size_t n) { writeSortedObject(itemWriter, results.ngramMaps[n], writeWeight); });
+    writer.endArray();
+    if (results.statistics != nullptr)
+    {
+        writer.key("statistics");
+        writer.beginArray(results.statistics->size());
+        for (auto const & s : *results.statistics)
+        {
+            writer.beginObject(3);
+            writer.key("conditional_entropy");
+            writer.value(s.conditionalEntropy);
+            writer.key("entropy");
+            writer.value(s.entropy);
+            writer.key("perplexity");
+            writer.value(s.perplexity);
+            writer.endObject();
+        }
+        writer.endArray();
+    }
+    writer.key("vowels");
+    writeSortedObject(writer, results.classNgrams.vowels, writeWeight);
+    writer.endObject();
+}
 
 } // anonymous namespace
 
 int main(int argc, char ** argv)
 {
     CLI::App    app{"Dictionary Analyzer"};
-    int         top_k       = 10;
-    bool        output_json = false;
+    int         top_k          = 10;
+    bool        output_json    = false;
+    std::string format         = "text";
+    bool        show_entropy   = false;
+    int         time_budget_ms = 0;
+    std::string checkpoint_path;
+    int         checkpoint_interval_s = 60;
+    bool        resume                = false;
+    std::string engine_name           = "hash";
+    std::string memory_limit;
+    std::string alphabet_path;
+    bool        extend_alphabet       = false;
+    bool        show_stats            = false;
+    unsigned    threads               = 1;
+    std::string partition             = "words";
+    double      min_weight            = 0.0;
+    bool        pipeline              = false;
+    std::string cache_directory;
+    bool        document_frequency    = false;
+    std::string save_model_path;
+    size_t      model_order           = 3;
+    std::string score_path;
+    std::string model_path;
+    size_t      generate_count        = 0;
+    uint64_t    seed                  = 1;
     std::string subtlex_path;
 
+    std::vector<std::string> contains;
+
+    std::vector<std::string> engine_names;
+    for (CountingEngine engine : countingEngines())
+    {
+        engine_names.emplace_back(countingEngineName(engine));
+    }
+
     app.add_option("-k", top_k, "Top K N-grams to display")->check(CLI::Range(1, 100));
-    app.add_flag("--json", output_json, "Output results in JSON format");
-    app.add_option("--subtlex", subtlex_path, "Path to SUBTLEX CSV file to load")->required();
+    auto json_option = app.add_flag("--json", output_json, "Output results in JSON format (same as --format json)");
+    app.add_option("--format", format, "Output format: text, json, cbor or msgpack (default: text)")
+        ->check(CLI::IsMember({"text", "json", "cbor", "msgpack"}))
+        ->excludes(json_option);
+    app.add_flag("--entropy", show_entropy, "Report the entropy, conditional entropy and perplexity of each n-gram length");
+    auto time_budget_option =
+        app.add_option("--time-budget", time_budget_ms, "Stop counting after MS milliseconds and report partial results")
+            ->check(CLI::PositiveNumber);
+    auto checkpoint_option =
+        app.add_option("--checkpoint", checkpoint_path, "Periodically save the counting state to this file");
+    app.add_option("--checkpoint-interval", checkpoint_interval_s, "Seconds between checkpoints (default: 60)")
+        ->check(CLI::PositiveNumber)
+        ->needs(checkpoint_option);
+    app.add_flag("--resume", resume, "Resume counting from the checkpoint file")->needs(checkpoint_option);
+    auto engine_option =
+        app.add_option("--engine", engine_name, "Counting engine (default: hash)")->check(CLI::IsMember(engine_names));
+    app.add_option("--threads", threads, "Number of counting threads (default: 1)")->check(CLI::Range(1, 256));
+    app.add_option("--partition",
+                   partition,
+                   "How the hash engine divides the counting among threads: words, merging per-thread tables, or "
+                   "lengths, sharing one table per length (default: words)")
+        ->check(CLI::IsMember({"words", "lengths"}));
+    app.add_option("--min-weight", min_weight, "Only report n-grams with at least this weight")
+        ->check(CLI::NonNegativeNumber)
+        ->excludes(time_budget_option)
+        ->excludes(checkpoint_option);
+    auto pipeline_option =
+        app.add_flag("--pipeline", pipeline, "Count the words while the SUBTLEX file is being read")
+            ->excludes(time_budget_option)
+            ->excludes(checkpoint_option);
+    auto cache_option =
+        app.add_option("--cache", cache_directory, "Reuse the counts of previous runs with the same input and options")
+            ->excludes(time_budget_option)
+            ->excludes(checkpoint_option);
+    auto document_frequency_option =
+        app.add_flag("--document-frequency",
+                     document_frequency,
+                     "Also report the number and weight of the words containing each n-gram")
+            ->excludes(time_budget_option)
+            ->excludes(checkpoint_option)
+            ->excludes(pipeline_option)
+            ->excludes(cache_option);
+    app.add_option("--memory-limit",
+                   memory_limit,
+                   "Use the fastest engine whose estimated memory fits this size, e.g. 512M or 2G, instead of --engine")
+        ->excludes(engine_option)
+        ->excludes(pipeline_option)
+        ->excludes(document_frequency_option);
+    app.add_option("--alphabet", alphabet_path, "Load the symbols and their classes from this file (default: English)")
+        ->check(CLI::ExistingFile);
+    // The alphabet is extended with the words, which a cache hit does not load
+    app.add_flag("--extend-alphabet", extend_alphabet, "Add every other character of the words to the alphabet")
+        ->excludes(pipeline_option)
+        ->excludes(cache_option);
+    app.add_flag("--stats", show_stats, "Report the counting engine, its memory estimates and the counting time");
+    auto save_model_option = app.add_option(
+        "--save-model", save_model_path, "Build a Kneser-Ney language model from the counts and save it to this file");
+    app.add_option("--model-order", model_order, "Order of the language model or pseudo-word generator (default: 3)")
+        ->check(CLI::Range(size_t(1), MAX_PACKED_NGRAM_LENGTH));
+    auto score_option = app.add_option(
+        "--score", score_path, "Print the log2 probability of each word in this file (- for standard input) and exit");
+    app.add_option("--model", model_path, "Score with the language model saved in this file instead of the counts")
+        ->check(CLI::ExistingFile)
+        ->needs(score_option)
+        ->excludes(save_model_option);
+    auto generate_option =
+        app.add_option("--generate", generate_count, "Print this many pseudo-words that follow the n-gram counts and exit")
+            ->check(CLI::PositiveNumber)
+            ->excludes(score_option);
+    app.add_option("--seed", seed, "Random seed of --generate (default: 1)")->needs(generate_option);
+    app.add_option("--contains",
+                   contains,
+                   "Print the words containing this substring, heaviest first, and exit; repeat it to require several")
+        ->excludes(time_budget_option)
+        ->excludes(checkpoint_option)
+        ->excludes(pipeline_option)
+        ->excludes(cache_option);
+    app.add_option("--subtlex", subtlex_path, "Path to SUBTLEX CSV file to load (required unless --model is given)");
     CLI11_PARSE(app, argc, argv);
 
-    std::unordered_map<std::string, DatasetImporter::Value> frequencies;
-    try
+    // A saved language model can score words without any counts
+    if (!model_path.empty())
     {
-        SubtlexImporter subtlex(subtlex_path);
-        std::cerr << "Loaded SUBTLEX file: " << subtlex_path << "\n";
-        frequencies = subtlex.get("SUBTLWF"); // Get word frequencies (per million)
-        std::cerr << "SUBTLEX words loaded: " << frequencies.size() << "\n";
+        try
+        {
+            return scoreWords(LanguageModel::load(model_path), score_path, threads);
+        }
+        catch (std::exception const & e)
+        {
+            std::cerr << "Error loading language model: " << e.what() << std::endl;
+            return 1;
+        }
     }
-    catch (std::exception const & e)
+    if (subtlex_path.empty())
     {
-        std::cerr << "Error loading SUBTLEX file: " << e.what() << std::endl;
+        std::cerr << "--subtlex is required" << std::endl;
         return 1;
     }
 
-    // Load words and count N-grams
-    std::vector<NGramMap> ngramMaps;
-    std::vector<double>   totalWeights;
-    int                   wordCount = 0;
+    double memoryLimit = 0.0;
+    if (!memory_limit.empty())
+    {
+        memoryLimit = parseByteSize(memory_limit);
+        if (memoryLimit <= 0.0)
+        {
+            std::cerr << "Invalid memory limit: " << memory_limit << std::endl;
+            return 1;
+        }
+    }
 
-    for (auto const & [word, value] : frequencies)
+    Alphabet alphabet;
+    if (!alphabet_path.empty())
     {
-        // Extend the data if necessary to accommodate a word of this length.
-        size_t wordLength = word.length();
-        if (ngramMaps.size() < wordLength + 1)
+        try
+        {
+            alphabet = Alphabet::load(alphabet_path);
+        }
+        catch (std::exception const & e)
         {
-            ngramMaps.resize(wordLength + 1);
-            totalWeights.resize(wordLength + 1, 0);
+            std::cerr << "Error loading alphabet: " << e.what() << std::endl;
+            return 1;
         }
+    }
 
-        // For each possible n-gram in the word, accumulate its count/frequency/weight.
-        double           weight   = std::get<double>(value); // The weight of an n-gram is the frequency of the word containing it.
-        std::string_view wordView = word;
-        for (size_t n = 1; n <= wordLength; ++n)
+    CountingOptions countingOptions;
+    countingOptions.threads     = threads;
+    countingOptions.minWeight   = min_weight;
+    countingOptions.alphabet    = &alphabet;
+    countingOptions.parallelism = (partition == "lengths") ? Parallelism::Lengths : Parallelism::Words;
+    for (CountingEngine engine : countingEngines())
+    {
+        if (countingEngineName(engine) == engine_name)
         {
-            for (size_t i = 0; i <= wordLength - n; ++i)
-            {
-                std::string ngram = std::string(wordView.substr(i, n));
+            countingOptions.engine = engine;
+        }
+    }
 
-                // Special handling for certain sequences
-                ngram = replaceSpecialSequences(ngram);
+    // The counting state is kept as a checkpoint so that it can be saved periodically
+    Checkpoint state;
+    WordList   words;
+    double     totalWordWeight = 0.0;
 
-                // Count the n-gram
-                size_t ngramSize = ngram.size();
-                auto & counts    = ngramMaps[ngramSize];
-                counts[std::string(ngram)] += weight;
-                totalWeights[ngramSize] += weight;
-            }
+    // Number and weight of the words containing each n-gram, indexed by length
+    std::vector<DocumentFrequencyMap> documentFrequencies;
+
+    // The cache key covers the input file and every option that changes the counts
+    std::optional<ResultCache> cache;
+    bool                       cached = false;
+    if (!cache_directory.empty())
+    {
+        std::ostringstream options;
+        options << "column=SUBTLWF;min-weight=" << std::hexfloat << min_weight;
+        try
+        {
+            cache.emplace(cache_directory, subtlex_path, options.str());
+        }
+        catch (std::exception const & e)
+        {
+            std::cerr << "Error loading SUBTLEX file: " << e.what() << std::endl;
+            return 1;
         }
-        ++wordCount;
-        if (wordCount % 10000 == 0)
+        if (auto entry = cache->load())
         {
-            std::cerr << "Processed " << wordCount << " words...\n";
+            state           = std::move(*entry);
+            totalWordWeight = state.inputWeight;
+            cached          = true;
+            std::cerr << "Loaded cached counts: " << cache->path() << "\n";
         }
     }
 
-    // Extract the counts for consonant-only and vowel-only n-grams
-    NGramMap consonantNgrams;
-    NGramMap vowelNgrams;
-    double   totalVowelNgrams     = 0.0;
-    double   totalConsonantNgrams = 0.0;
-    for (auto const & ngram_map : ngramMaps)
+    if (cached)
+    {
+        // The counts are complete
+    }
+    else if (pipeline)
     {
-        for (auto const & [ngram, weight] : ngram_map)
+        // Count the words while the file is still being read, without storing them
+        try
+        {
+            PipelinedCounter counter(countingOptions);
+            SubtlexImporter::forEach(subtlex_path,
+                                     "SUBTLWF", // Word frequencies (per million)
+                                     [&counter](std::string const & word, DatasetImporter::Value const & value)
+                                     { counter.add(word, std::get<double>(value)); });
+            std::cerr << "Loaded SUBTLEX file: " << subtlex_path << "\n";
+            std::cerr << "SUBTLEX words loaded: " << counter.words() << "\n";
+            state.counts          = counter.finish();
+            state.position        = counter.words();
+            state.processedWeight = counter.weight();
+            state.inputWords      = counter.words();
+            state.inputWeight     = counter.weight();
+            totalWordWeight       = counter.weight();
+        }
+        catch (std::exception const & e)
+        {
+            std::cerr << "Error loading SUBTLEX file: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    else
+    {
+        std::unordered_map<std::string, DatasetImporter::Value> frequencies;
+        try
+        {
+            SubtlexImporter subtlex(subtlex_path);
+            std::cerr << "Loaded SUBTLEX file: " << subtlex_path << "\n";
+            frequencies = subtlex.get("SUBTLWF"); // Get word frequencies (per million)
+            std::cerr << "SUBTLEX words loaded: " << frequencies.size() << "\n";
+        }
+        catch (std::exception const & e)
+        {
+            std::cerr << "Error loading SUBTLEX file: " << e.what() << std::endl;
+            return 1;
+        }
+
+        // Order the words by descending weight (ties broken by the word) so that the heaviest words are counted first. If
+        // the time budget expires, the partial results then cover as much of the total weight as possible.
+        words.reserve(frequencies.size());
+        for (auto const & [word, value] : frequencies)
+        {
+            words.emplace_back(word, std::get<double>(value));
+            totalWordWeight += words.back().second;
+        }
+        std::sort(words.begin(),
+                  words.end(),
+                  [](auto const & a, auto const & b)
+                  { return (a.second != b.second) ? b.second < a.second : a.first < b.first; });
+
+        state.inputWords  = words.size();
+        state.inputWeight = totalWordWeight;
+        if (extend_alphabet)
+        {
+            alphabet = Alphabet::fromWords(words, alphabet);
+            std::cerr << "Alphabet symbols: " << alphabet.size() << " (" << alphabet.symbolBits() << " bits each)\n";
+        }
+        if (resume)
         {
-            // If every characters in ngram is in VOWELS, it's a vowel n-gram
-            if (ngram.find_first_not_of(VOWELS) == std::string_view::npos)
+            try
             {
-                vowelNgrams[ngram] = weight;
-                totalVowelNgrams += weight;
+                state = Checkpoint::load(checkpoint_path);
             }
-            else if (ngram.find_first_not_of(CONSONANTS) == std::string_view::npos)
+            catch (std::exception const & e)
             {
-                consonantNgrams[ngram] = weight;
-                totalConsonantNgrams += weight;
+                std::cerr << "Error loading checkpoint: " << e.what() << std::endl;
+                return 1;
             }
+            if (state.inputWords != words.size() || state.inputWeight != totalWordWeight || state.position > words.size())
+            {
+                std::cerr << "Error loading checkpoint: " << checkpoint_path << " was created from different input"
+                          << std::endl;
+                return 1;
+            }
+            std::cerr << "Resuming from checkpoint at word " << state.position << "\n";
         }
     }
 
-    if (output_json)
-    {
-        json j;
-        j["ngrams"]     = ngramMaps;
-        j["vowels"]     = vowelNgrams;
-        j["consonants"] = consonantNgrams;
-        std::cout << j.dump(2) << "\n";
-    }
-    else
+    // Answer substring queries from an index of the words instead of counting
+    if (!contains.empty())
     {
-        std::cout << "Total words processed: " << wordCount << "\n";
+        auto const            indexStart = std::chrono::steady_clock::now();
+        NGramIndex const      index      = NGramIndex::build(words, threads, alphabet);
+        auto const            queryStart = std::chrono::steady_clock::now();
+        std::vector<uint32_t> ids        = index.wordsContaining(contains[0]);
+        for (size_t i = 1; i < contains.size(); ++i)
+        {
+            ids = intersectPostings(ids, index.wordsContaining(contains[i]));
+        }
+        auto const queryEnd = std::chrono::steady_clock::now();
 
-        // Display results for each N
-        int ngramSize = 0;
-        for (auto const & ngram_map : ngramMaps)
+        double weight = 0.0;
         {
-            if (ngram_map.empty())
+            TextWriter out(std::cout);
+            for (uint32_t id : ids)
             {
-                ++ngramSize;
-                continue;
+                out << index.word(id) << '\t' << index.weight(id) << '\n';
+                weight += index.weight(id);
             }
+        }
+        std::cout.flush();
+        std::cerr << "Matching words: " << ids.size() << ", total weight " << weight << "\n";
+        if (show_stats)
+        {
+            std::chrono::duration<double, std::milli> const indexTime = queryStart - indexStart;
+            std::chrono::duration<double, std::milli> const queryTime = queryEnd - queryStart;
+            std::cerr << "Index: " << index.ngrams() << " n-grams, " << formatMebibytes(index.postingBytes())
+                      << " of postings, built in " << indexTime.count() << " ms\n";
+            std::cerr << "Query time: " << queryTime.count() << " ms\n";
+        }
+        return 0;
+    }
+
+    // Choose the engine from the estimated sizes of the tables of the words left to count
+    std::optional<EngineSelection> selection;
+    if (memoryLimit > 0.0 && state.position < words.size())
+    {
+        selection              = selectCountingEngine(words, state.position, words.size(), countingOptions, memoryLimit);
+        countingOptions.engine = selection->engine;
+        if (!selection->fits)
+        {
+            std::cerr << "No counting engine is estimated to fit in " << formatMebibytes(memoryLimit) << ", using "
+                      << countingEngineName(selection->engine) << "\n";
+        }
+    }
+
+    // Words are counted in chunks, between which the time budget and the checkpoint interval are checked. Use small chunks
+    // when there is a time budget so that it is not overrun by much. A weight threshold applies to the whole input, so the
+    // words are then counted in one chunk.
+    size_t const chunkSize     = (min_weight > 0.0) ? words.size() : (time_budget_ms > 0) ? 256 : 10000;
+    bool         budgetExpired = false;
 
-            // Convert map to vector and sort by weight
-            std::vector<std::pair<std::string, double>> ngram_vector;
-            for (auto const & [ngram, weight] : ngram_map)
+    auto const deadline       = std::chrono::steady_clock::now() + std::chrono::milliseconds(time_budget_ms);
+    auto const interval       = std::chrono::seconds(checkpoint_interval_s);
+    auto       nextCheckpoint = std::chrono::steady_clock::now() + interval;
+    auto const countingStart  = std::chrono::steady_clock::now();
+    while (state.position < words.size())
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (time_budget_ms > 0 && now >= deadline)
+        {
+            budgetExpired = true;
+            break;
+        }
+        if (!checkpoint_path.empty() && now >= nextCheckpoint)
+        {
+            try
             {
-                ngram_vector.emplace_back(ngram, weight);
+                state.save(checkpoint_path);
             }
-            std::sort(ngram_vector.begin(),
-                      ngram_vector.end(),
-                      [](auto const & a, auto const & b)
-                      {
-                          return b.second < a.second; // Sort in descending order
-                      });
-
-            std::cout << "Total " << ngramSize << "-grams counted: " << ngram_vector.size() << "\n";
-
-            // Display top K N-grams
-            std::cout << "Top " << top_k << " " << ngramSize << "-grams:\n";
-            for (int j = 0; j < std::min(top_k, static_cast<int>(ngram_vector.size())); ++j)
+            catch (std::exception const & e)
             {
-                double p = ngram_vector[j].second / totalWeights[ngramSize];
-                std::cout << ngram_vector[j].first << ": " << ngram_vector[j].second << " (" << p * 100 << "%)" << "\n";
+                std::cerr << "Error saving checkpoint: " << e.what() << std::endl;
+                return 1;
             }
-            std::cout << "\n";
-            ++ngramSize;
+            nextCheckpoint = now + interval;
         }
 
-        // Display the total weight of n-grams processed
-        double total_ngrams = std::accumulate(totalWeights.begin(), totalWeights.end(), 0.0);
-        std::cout << "Total weight of n-grams processed: " << total_ngrams << "\n";
+        size_t chunkEnd = std::min<size_t>(state.position + chunkSize, words.size());
+        if (document_frequency)
+        {
+            countDocumentFrequencies(state.counts, documentFrequencies, words, state.position, chunkEnd, countingOptions);
+        }
+        else
+        {
+            countNGrams(state.counts, words, state.position, chunkEnd, countingOptions);
+        }
+        for (size_t i = state.position; i < chunkEnd; ++i)
+        {
+            state.processedWeight += words[i].second;
+        }
+        if (chunkEnd / 10000 != state.position / 10000)
+        {
+            std::cerr << "Processed " << chunkEnd << " words...\n";
+        }
+        state.position = chunkEnd;
     }
-    return 0;
-}
+    std::chrono::duration<double> const countingTime = std::chrono::steady_clock::now() - countingStart;
 
-namespace
-{
+    // Save the final state so that a run stopped by the time budget can be resumed later
+    if (!checkpoint_path.empty())
+    {
+        try
+        {
+            state.save(checkpoint_path);
+        }
+        catch (std::exception const & e)
+        {
+            std::cerr << "Error saving checkpoint: " << e.what() << std::endl;
+            return 1;
+        }
+    }
 
-std::string replaceSpecialSequences(std::string const & input)
-{
-    std::string_view inputView = input;
+    // Cache the counts for the next run with the same input and options
+    if (cache && !cached)
+    {
+        try
+        {
+            cache->store(state);
+            std::cerr << "Cached counts: " << cache->path() << "\n";
+        }
+        catch (std::exception const & e)
+        {
+            std::cerr << "Error caching counts: " << e.what() << std::endl;
+            return 1;
+        }
+    }
 
-    std::string result;
-    result.reserve(input.size()); // Reserve enough space
+    std::vector<NGramMap> const & ngramMaps    = state.counts.ngramMaps;
+    std::vector<double> const &   totalWeights = state.counts.totalWeights;
+    int const                     wordCount    = static_cast<int>(state.position);
 
-    size_t i = 0;
-    while (i < input.size())
+    // Fraction of the total word weight covered by the words that were counted
+    double coverage = (totalWordWeight > 0.0) ? state.processedWeight / totalWordWeight : 1.0;
+    if (budgetExpired)
     {
-        char c0 = input[i++];
+        std::cerr << "Time budget expired after " << wordCount << " of " << words.size() << " words (" << coverage * 100
+                  << "% of total weight)\n";
+    }
 
-        // It's the next character that determines what to do, so always push the current character
-        result.push_back(c0);
+    if (show_stats)
+    {
+        std::cerr << "Counting engine: " << countingEngineName(countingOptions.engine);
+        if (selection)
+        {
+            std::cerr << " (" << (selection->fits ? "fastest to fit in " : "smallest, none fits in ")
+                      << formatMebibytes(memoryLimit) << ")";
+        }
+        std::cerr << "\nCounting time: " << countingTime.count() << " s\n";
+        if (selection)
+        {
+            std::cerr << "Estimated memory:";
+            for (auto const & candidate : selection->candidates)
+            {
+                std::cerr << " " << countingEngineName(candidate.engine) << " " << formatMebibytes(candidate.bytes) << ";";
+            }
+            std::cerr << "\nEstimated distinct n-grams:";
+            for (size_t n = 1; n < selection->estimate.distinctNGrams.size(); ++n)
+            {
+                std::cerr << " " << n << ": " << static_cast<uint64_t>(selection->estimate.distinctNGrams[n] + 0.5) << ";";
+            }
+            std::cerr << "\n";
+        }
+    }
 
-        // The replaced sequences are all two characters long, so only check if there's a next character
-        if (i < input.size())
+    // Build the language model, to save it or to score words with it
+    if (!save_model_path.empty() || !score_path.empty())
+    {
+        LanguageModel model = LanguageModel::build(state.counts, model_order);
+        if (!save_model_path.empty())
         {
-            char c1 = input[i];
-            // Replace 'y' preceded by certain vowels or any consonant with 'Y'
-            if (c1 == 'y')
+            try
             {
-                if (c0 == 'a' || c0 == 'e' || c0 == 'o' || c0 == 'u' || CONSONANTS.find(c0) != std::string_view::npos)
-                {
-                    result.push_back('Y');
-                    ++i; // Eat two characters
-                }
+                model.save(save_model_path);
+                std::cerr << "Saved order " << model.order() << " language model: " << save_model_path << "\n";
             }
-            // Replace 'w' preceded by certain vowels with 'W'
-            else if (c1 == 'w')
+            catch (std::exception const & e)
             {
-                if (c0 == 'a' || c0 == 'e' || c0 == 'o')
-                {
-                    result.push_back('W');
-                    ++i; // Eat two characters
-                }
+                std::cerr << "Error saving language model: " << e.what() << std::endl;
+                return 1;
             }
+        }
+        if (!score_path.empty())
+        {
+            return scoreWords(model, score_path, threads);
+        }
+    }
 
-            // Replace "qu" with 'Q'
-            if (c0 == 'q')
+    // Generate pseudo-words
+    if (generate_count > 0)
+    {
+        PseudoWordGenerator generator = PseudoWordGenerator::build(state.counts, model_order);
+        {
+            TextWriter out(std::cout);
+            for (auto const & word : generator.generate(generate_count, seed, threads))
             {
-                if (c1 == 'u')
-                {
-                    result.back() = 'Q'; // Replace 'q' that was already pushed with 'Q'. Forget the 'u'.
-                    ++i;                 // Eat two characters
-                }
+                out << word << '\n';
             }
         }
+        std::cout.flush();
+        return 0;
     }
 
-    return result;
-}
+    // Extract the counts for consonant-only and vowel-only n-grams
+    VowelConsonantNGrams classNgrams = extractVowelConsonantNGrams(state.counts, alphabet);
 
-} // anonymous namespace
+    std::vector<NGramStatistics> statistics;
+    if (show_entropy)
+    {
+        statistics = computeStatistics(state.counts, threads);
+    }
+
+    Results const results{ngramMaps,
+                          classNgrams,
+                          (time_budget_ms > 0) ? &coverage : nullptr,
+                          document_frequency ? &documentFrequencies : nullptr,
+                          show_entropy ? &statistics : nullptr};
+    if (output_json || format == "json")
+    {
+        JsonWriter writer(std::cout);
+        writeResults(writer, std::cout, results, threads);
+        writer.flush();
+        std::cout << "\n";
+    }
+    else if (format == "cbor" || format == "msgpack")
+    {
+        BinaryWriter writer(std::cout, (format == "cbor") ? BinaryFormat::Cbor : BinaryFormat::MessagePack);
+        writeResults(writer, std::cout, results, threads);
+        writer.flush();
+    }
+    else
+    {
+        TextWriter out(std::cout);
+        out << "Total words processed: " << wordCount << "\n";
+        if (time_budget_ms > 0)
+        {
+            out << "Fraction of total weight covered: " << coverage * 100 << "%\n";
+        }
+        out.flush();
+
+        // Display results for each N, formatting the lengths on several threads
+        writeOrdered(std::cout,
+                     ngramMaps.size(),
+                     threads,
+                     [&](size_t ngramSize, std::ostream & section)
+                     {
+                         NGramMap const & ngram_map = ngramMaps[ngramSize];
+                         if (ngram_map.empty())
+                         {
+                             return;
+                         }
+
+                         // Convert map to vector and sort by descending weight, breaking ties on the n-gram so that the
+                         // order does not depend on the order of the map. Engines and threads sum the weights in different
+                         // orders, so the weights are compared in single precision, whose rounding hides the differences.
+                         std::vector<std::pair<std::string, double>> ngram_vector;
+                         for (auto const & [ngram, weight] : ngram_map)
+                         {
+                             ngram_vector.emplace_back(ngram, weight);
+                         }
+                         std::sort(ngram_vector.begin(),
+                                   ngram_vector.end(),
+                                   [](auto const & a, auto const & b)
+                                   {
+                                       float const weightA = static_cast<float>(a.second);
+                                       float const weightB = static_cast<float>(b.second);
+                                       return (weightA != weightB) ? weightB < weightA : a.first < b.first;
+                                   });
+
+                         TextWriter out(section);
+                         out << "Total " << ngramSize << "-grams counted: " << ngram_vector.size() << "\n";
+
+                         // Display top K N-grams
+                         out << "Top " << top_k << " " << ngramSize << "-grams:\n";
+                         double const total = totalWeights[ngramSize];
+                         for (int j = 0; j < std::min(top_k, static_cast<int>(ngram_vector.size())); ++j)
+                         {
+                             double p = ngram_vector[j].second / total;
+                             out << ngram_vector[j].first << ": " << ngram_vector[j].second << " (" << p * 100 << "%)";
+                             if (document_frequency)
+                             {
+                                 DocumentFrequency const & frequency =
+                                     documentFrequencies[ngramSize].at(ngram_vector[j].first);
+                                 out << " in " << frequency.words << " words (" << frequency.weight << ")";
+                             }
+                             out << "\n";
+                         }
+                         out << "\n";
+                     });
+
+        // Display the total weight of n-grams processed
+        double total_ngrams = std::accumulate(totalWeights.begin(), totalWeights.end(), 0.0);
+        out << "Total weight of n-grams processed: " << total_ngrams << "\n";
+
+        // Display the entropy statistics for each N
+        if (show_entropy)
+        {
+            out << "\nEntropy (bits), conditional entropy (bits) and perplexity of each N:\n";
+            for (size_t n = 1; n < statistics.size(); ++n)
+            {
+                out << n << "-grams: H = " << statistics[n].entropy << ", H(Xn | X1..Xn-1) = " << statistics[n].conditionalEntropy
+                    << ", perplexity = " << statistics[n].perplexity << "\n";
+            }
+        }
+    }
+    return 0;
+}